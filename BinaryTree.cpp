@@ -4,25 +4,44 @@ Author: Adar Shapira, ID: 209580208
         Almog Talker, ID: 322546680
 *****************************************/
 #include "BinaryTree.h"
+#include "BloomFilter.h"
+#include "OperationLog.h"
+#include "Scapegoat.h"
+#include "SetAlgebra.h"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
+#include <thread>
 
-// --- Private Helper Constructor ---
+// Subtrees smaller than this are built on the calling thread
+static const size_t kParallelBuildThreshold = 1 << 15;
+
+// Number of interleaved lookups in searchMany; enough to cover memory latency
+static const size_t kLookupsInFlight = 16;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address) ((void)0)
+#endif
+
+// --- Node ---
 
 // Constructor for creating new nodes within the tree structure.
-BinaryTree::BinaryTree(int val) : data(val), left(nullptr), right(nullptr), is_empty_root_flag(false) {}
+BinaryTree::Node::Node(int val) : data(val), left(nullptr), right(nullptr) {}
 
 // --- Private Helper Functions ---
 
 // Helper for recursive insertion
 // Returns the root of the subtree after insertion
-BinaryTree* BinaryTree::_insert(BinaryTree* node, int value) {
+BinaryTree::Node* BinaryTree::_insert(Node* node, int value) {
     if (node == nullptr) {
-        return new BinaryTree(value);
+        return new Node(value);
     }
     if (value < node->data) {
         node->left = _insert(node->left, value);
     }
-    else if (value >= node->data) {
+    else {
         node->right = _insert(node->right, value);
     }
     return node;
@@ -30,7 +49,7 @@ BinaryTree* BinaryTree::_insert(BinaryTree* node, int value) {
 
 // Helper for recursive search
 // Returns true if the value is found in the subtree, false otherwise
-bool BinaryTree::_search(const BinaryTree* node, int value) const {
+bool BinaryTree::_search(const Node* node, int value) const {
     if (node == nullptr) {
         return false;
     }
@@ -47,18 +66,18 @@ bool BinaryTree::_search(const BinaryTree* node, int value) const {
 
 // Helper for recursive in-order printing
 // Prints the elements of the subtree in ascending order
-void BinaryTree::_printInOrder(const BinaryTree* node) const {
+void BinaryTree::_printInOrder(const Node* node, std::ostream& os) const {
     if (node == nullptr) {
         return;
     }
-    _printInOrder(node->left);
-    std::cout << node->data << " ";
-    _printInOrder(node->right);
+    _printInOrder(node->left, os);
+    os << node->data << " ";
+    _printInOrder(node->right, os);
 }
 
 // Helper for recursive getMinValue
 // Finds the minimum value in the subtree
-int BinaryTree::_getMinValue(const BinaryTree* node) const {
+int BinaryTree::_getMinValue(const Node* node) const {
     if (node == nullptr) {
         // This case should be caught by the public getMinValue()
         throw std::runtime_error("Error: _getMinValue called on nullptr node.");
@@ -72,7 +91,7 @@ int BinaryTree::_getMinValue(const BinaryTree* node) const {
 
 // Helper for recursive getMaxValue
 // Finds the maximum value in the subtree
-int BinaryTree::_getMaxValue(const BinaryTree* node) const {
+int BinaryTree::_getMaxValue(const Node* node) const {
     if (node == nullptr) {
         // This case should be caught by the public getMaxValue()
         throw std::runtime_error("Error: _getMaxValue called on nullptr node.");
@@ -86,11 +105,11 @@ int BinaryTree::_getMaxValue(const BinaryTree* node) const {
 
 // Helper for deep copying a subtree
 // Creates a new subtree that is a deep copy of the given other_node
-BinaryTree* BinaryTree::_copy(const BinaryTree* otherNode) {
+BinaryTree::Node* BinaryTree::_copy(const Node* otherNode) {
     if (otherNode == nullptr) {
         return nullptr;
     }
-    BinaryTree* newNode = new BinaryTree(otherNode->data);
+    Node* newNode = new Node(otherNode->data);
     newNode->left = _copy(otherNode->left);
     newNode->right = _copy(otherNode->right);
     return newNode;
@@ -98,7 +117,7 @@ BinaryTree* BinaryTree::_copy(const BinaryTree* otherNode) {
 
 // Helper for deep destruction of a subtree (post-order traversal for deletion)
 // Deletes all nodes in the given subtree
-void BinaryTree::_destroy(BinaryTree* node) {
+void BinaryTree::_destroy(Node* node) {
     if (node == nullptr) {
         return;
     }
@@ -108,45 +127,48 @@ void BinaryTree::_destroy(BinaryTree* node) {
 }
 
 // Helper for recursive removal
-BinaryTree* BinaryTree::_remove(BinaryTree* node, int value) {
+// Returns the root of the subtree after removal, removed_flag tells whether a node was removed
+BinaryTree::Node* BinaryTree::_remove(Node* node, int value, bool& removed_flag) {
     if (node == nullptr) {
         return nullptr;
     }
 
     if (value < node->data) {
-        node->left = _remove(node->left, value);
+        node->left = _remove(node->left, value, removed_flag);
     }
     else if (value > node->data) {
-        node->right = _remove(node->right, value);
+        node->right = _remove(node->right, value, removed_flag);
     }
     else { // node->data == value. this is the node to be removed
+        removed_flag = true;
         // No child or one child
         if (node->left == nullptr) {
-            BinaryTree* temp = node->right;
+            Node* temp = node->right;
             delete node;
             return temp;
         }
         else if (node->right == nullptr) {
-            BinaryTree* temp = node->left;
+            Node* temp = node->left;
             delete node;
             return temp;
         }
 
         // Two children
         // Get the inorder successor (smallest in the right subtree)
-        BinaryTree* temp = _findMinNode(node->right);
+        Node* temp = _findMinNode(node->right);
 
         // Copy the inorder successor's content to this node
         node->data = temp->data;
 
         // Delete the inorder successor from the right subtree
-        node->right = _remove(node->right, temp->data);
+        bool successor_removed = false;
+        node->right = _remove(node->right, temp->data, successor_removed);
     }
     return node;
 }
 
 // Helper to find node with min value in a subtree (used by _remove)
-BinaryTree* BinaryTree::_findMinNode(BinaryTree* node) {
+BinaryTree::Node* BinaryTree::_findMinNode(Node* node) {
     // Assume node is not nullptr when called
     while (node->left != nullptr) {
         node = node->left;
@@ -154,77 +176,401 @@ BinaryTree* BinaryTree::_findMinNode(BinaryTree* node) {
     return node;
 }
 
+// Helper to add every value of a subtree to the membership filter
+void BinaryTree::_fillFilter(const Node* node, CountingBloomFilter& target) const {
+    if (node == nullptr) {
+        return;
+    }
+    _fillFilter(node->left, target);
+    target.insert(node->data);
+    _fillFilter(node->right, target);
+}
+
+// Helper to rotate child up into the place of its parent *link
+// The in-order sequence is unchanged, only the shape of the subtree
+void BinaryTree::_rotateUp(Node** link, Node* child) const {
+    Node* parent = *link;
+    if (parent->left == child) {
+        parent->left = child->right;
+        child->right = parent;
+    }
+    else {
+        parent->right = child->left;
+        child->left = parent;
+    }
+    *link = child;
+    rotations++;
+}
+
+// Helper for search in a self-adjusting mode
+// Records the links on the way down so the hit can be rotated up without parent pointers
+bool BinaryTree::_searchAndAdjust(int value) const {
+    access_path.clear();
+    Node** link = &root;
+    while (*link != nullptr) {
+        Node* node = *link;
+        access_path.push_back(link);
+        if (node->data == value) {
+            break;
+        }
+        link = value < node->data ? &node->left : &node->right;
+    }
+    if (*link == nullptr) {
+        return false;
+    }
+    access_hits++;
+    if (access_hits % access_sample_period != 0) {
+        return true;
+    }
+
+    // access_path[i] is the link that currently holds the node being moved up
+    size_t i = access_path.size() - 1;
+    if (access_mode == AccessMode::MoveToRoot) {
+        for (; i > 0; i--) {
+            _rotateUp(access_path[i - 1], *access_path[i]);
+        }
+        return true;
+    }
+
+    // Semi-splaying: like splaying, but a zig-zig step continues from the parent,
+    // so each step only halves the depth of the path instead of reversing it
+    while (i >= 2) {
+        Node* node = *access_path[i];
+        Node* parent = *access_path[i - 1];
+        Node* grandparent = *access_path[i - 2];
+        if ((parent->left == node) == (grandparent->left == parent)) {
+            // zig-zig: lift the parent over the grandparent and continue from the parent
+            _rotateUp(access_path[i - 2], parent);
+        }
+        else {
+            // zig-zag: lift the node twice
+            _rotateUp(access_path[i - 1], node);
+            _rotateUp(access_path[i - 2], node);
+        }
+        i -= 2;
+    }
+    if (i == 1) {
+        _rotateUp(access_path[0], *access_path[1]);
+    }
+    return true;
+}
+
+// Helper to append the values of a subtree in ascending order
+// Uses an explicit stack so a degenerate (list shaped) tree cannot overflow the call stack
+void BinaryTree::_collectInOrder(const Node* node, std::vector<int>& out) const {
+    std::vector<const Node*> stack;
+    while (node != nullptr || !stack.empty()) {
+        while (node != nullptr) {
+            stack.push_back(node);
+            node = node->left;
+        }
+        node = stack.back();
+        stack.pop_back();
+        out.push_back(node->data);
+        node = node->right;
+    }
+}
+
+// Helper to build a balanced subtree from sorted values
+// The middle value becomes the root; large halves are built on separate threads
+BinaryTree::Node* BinaryTree::_buildBalanced(const int* values, size_t size, unsigned spare_threads) {
+    if (size == 0) {
+        return nullptr;
+    }
+    size_t mid = size / 2;
+    Node* node = new Node(values[mid]);
+    if (spare_threads > 0 && size >= kParallelBuildThreshold) {
+        unsigned right_threads = (spare_threads - 1) / 2;
+        unsigned left_threads = spare_threads - 1 - right_threads;
+        std::thread right_builder([=] {
+            node->right = _buildBalanced(values + mid + 1, size - mid - 1, right_threads);
+        });
+        node->left = _buildBalanced(values, mid, left_threads);
+        right_builder.join();
+    }
+    else {
+        node->left = _buildBalanced(values, mid, 0);
+        node->right = _buildBalanced(values + mid + 1, size - mid - 1, 0);
+    }
+    return node;
+}
+
+// Helper to move the inline values into a balanced tree of nodes
+void BinaryTree::_promote() {
+    root = _buildBalanced(small_values.begin(), small_values.size(), 0);
+    max_count = small_values.size();
+    small_values.clear();
+}
+
+// Helper to move the values of a small node tree back into the inline array
+void BinaryTree::_demote() {
+    std::vector<int> values;
+    values.reserve(count);
+    _collectInOrder(root, values);
+    _destroy(root);
+    root = nullptr;
+    for (size_t i = 0; i < values.size(); i++) {
+        small_values.pushBack(values[i]);
+    }
+}
+
+// Returns true if looking up small values one descent each in a tree of large values is
+// cheaper than walking the whole tree (about log2(large) node visits per lookup)
+static bool probingIsCheaper(size_t small, size_t large) {
+    size_t depth = 1;
+    while ((large >> depth) != 0) {
+        depth++;
+    }
+    return small * depth < large;
+}
+
+// Helper for the set operations
+// When the result can only hold values of a much smaller tree (an intersection, or a
+// difference from the smaller tree), the smaller tree's values are looked up in the larger
+// one with interleaved descents, so the larger tree is never walked. Otherwise both trees
+// are flattened in order, merged slice by slice, and the result is built balanced.
+BinaryTree BinaryTree::_setOperation(const BinaryTree& other, SetOperation op) const {
+    bool probe_other = (op == SetOperation::Intersection || op == SetOperation::Difference) &&
+                       probingIsCheaper(count, other.count);
+    bool probe_this = op == SetOperation::Intersection && probingIsCheaper(other.count, count);
+    if (probe_other || probe_this) {
+        const BinaryTree& driver = probe_other ? *this : other;
+        std::vector<int> values;
+        values.reserve(driver.count);
+        driver.appendInOrder(values);
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        std::vector<bool> found;
+        (probe_other ? other : *this).searchMany(values, found);
+        bool keep_found = op == SetOperation::Intersection;
+        size_t kept = 0;
+        for (size_t i = 0; i < values.size(); i++) {
+            if (found[i] == keep_found) {
+                values[kept++] = values[i];
+            }
+        }
+        values.resize(kept);
+        return fromSorted(values);
+    }
+
+    std::vector<int> mine;
+    std::vector<int> theirs;
+    mine.reserve(count);
+    theirs.reserve(other.count);
+    appendInOrder(mine);
+    other.appendInOrder(theirs);
+
+    std::vector<int> merged;
+    parallelSetOperation(op, mine, theirs, merged);
+    return fromSorted(merged);
+}
+
+// Helper function for insert with shape maintenance
+// Inserts iteratively while recording the path; a node deeper than the alpha height bound
+// makes the scapegoat above it rebuild its subtree (see Scapegoat.h)
+void BinaryTree::_insertBalanced(int value) {
+    access_path.clear();
+    Node** link = &root;
+    while (*link != nullptr) {
+        access_path.push_back(link);
+        link = value < (*link)->data ? &(*link)->left : &(*link)->right;
+    }
+    *link = new Node(value);
+
+    size_t size = count + 1;
+    if (size > max_count) {
+        max_count = size;
+    }
+    if (!Scapegoat<Node>::tooDeep(access_path.size(), size, balance_alpha)) {
+        return;
+    }
+    size_t scapegoat_size = 0;
+    Node** scapegoat = Scapegoat<Node>::findScapegoat(access_path, *link, balance_alpha, scapegoat_size);
+    if (scapegoat != nullptr) {
+        _rebuild(scapegoat, scapegoat_size);
+    }
+}
+
+// Helper function to rebuild a subtree in place
+void BinaryTree::_rebuild(Node** link, size_t size) {
+    Scapegoat<Node>::rebuild(link, size);
+    rebuilds++;
+    rebuilt_nodes += size;
+}
+
 // --- Public Member Functions ---
 
 // Default Constructor, initializes the tree to an empty state
-BinaryTree::BinaryTree() : data(0), left(nullptr), right(nullptr), is_empty_root_flag(true) {}
+BinaryTree::BinaryTree()
+    : root(nullptr), count(0), filter(nullptr), log(nullptr), access_mode(AccessMode::Plain), access_sample_period(1),
+      access_hits(0), rotations(0), balance_alpha(0), max_count(0), rebuilds(0), rebuilt_nodes(0) {}
 
 // Destructor, cleans up all dynamic memory in the tree
 BinaryTree::~BinaryTree() {
-    // Only destroy if it's not an empty root flag or if it's a non-root node.
-    if (!is_empty_root_flag || left != nullptr || right != nullptr) {
-        // Destroy the children first
-        _destroy(left);
-        _destroy(right);
-    }
-    left = nullptr;
-    right = nullptr;
+    _destroy(root);
+    root = nullptr;
+    delete filter;
 }
 
 // Copy Constructor (Deep Copy), creates a new BinaryTree object that is a deep copy of other
-BinaryTree::BinaryTree(const BinaryTree& other) : data(0), left(nullptr), right(nullptr), is_empty_root_flag(true) {
-    if (!other.isEmpty()) {
-        this->data = other.data;
-        this->left = _copy(other.left);
-        this->right = _copy(other.right);
-        this->is_empty_root_flag = false;
+BinaryTree::BinaryTree(const BinaryTree& other)
+    : root(nullptr), count(0), filter(nullptr), log(nullptr), access_mode(other.access_mode),
+      access_sample_period(other.access_sample_period), access_hits(0), rotations(0),
+      balance_alpha(other.balance_alpha), max_count(other.count), rebuilds(0), rebuilt_nodes(0) {
+    small_values = other.small_values;
+    root = _copy(other.root);
+    count = other.count;
+    if (other.filter != nullptr) {
+        filter = new CountingBloomFilter(*other.filter);
     }
 }
 
 // Assigns the content of other to the current BinaryTree object
+// An attached log keeps logging this tree; other's values are written to it as a snapshot first
 BinaryTree& BinaryTree::operator=(const BinaryTree& other) {
     if (this == &other) {
         return *this;
     }
+    if (log != nullptr) {
+        log->compact(other);
+    }
 
     // Deallocate existing resources of the current tree
-    _destroy(left);
-    _destroy(right);
-    left = nullptr;
-    right = nullptr;
+    _destroy(root);
+    root = nullptr;
+    delete filter;
+    filter = nullptr;
 
     // Copy data from other
-    if (other.isEmpty()) {
-        this->is_empty_root_flag = true;
-        this->data = 0; // Default uninitialized value
-    } else {
-        this->data = other.data;
-        this->left = _copy(other.left);
-        this->right = _copy(other.right);
-        this->is_empty_root_flag = false;
+    small_values = other.small_values;
+    root = _copy(other.root);
+    count = other.count;
+    if (other.filter != nullptr) {
+        filter = new CountingBloomFilter(*other.filter);
+    }
+    access_mode = other.access_mode;
+    access_sample_period = other.access_sample_period;
+    balance_alpha = other.balance_alpha;
+    max_count = other.count;
+    return *this;
+}
+
+// Move Constructor, takes over the nodes and filter of other
+BinaryTree::BinaryTree(BinaryTree&& other) noexcept
+    : small_values(other.small_values), root(other.root), count(other.count), filter(other.filter), log(other.log),
+      access_mode(other.access_mode), access_sample_period(other.access_sample_period),
+      access_hits(other.access_hits), rotations(other.rotations), balance_alpha(other.balance_alpha),
+      max_count(other.max_count), rebuilds(other.rebuilds), rebuilt_nodes(other.rebuilt_nodes) {
+    other.small_values.clear();
+    other.root = nullptr;
+    other.count = 0;
+    other.filter = nullptr;
+    other.log = nullptr;
+}
+
+// Move Assignment, frees the current nodes and takes over those of other
+// An attached log is kept and gets other's values as a snapshot; otherwise other's log comes along
+BinaryTree& BinaryTree::operator=(BinaryTree&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (log != nullptr) {
+        log->compact(other);
     }
+    else {
+        log = other.log;
+    }
+    _destroy(root);
+    delete filter;
+    small_values = other.small_values;
+    other.small_values.clear();
+    root = other.root;
+    count = other.count;
+    filter = other.filter;
+    access_mode = other.access_mode;
+    access_sample_period = other.access_sample_period;
+    balance_alpha = other.balance_alpha;
+    max_count = other.max_count;
+    rebuilds = other.rebuilds;
+    rebuilt_nodes = other.rebuilt_nodes;
+    other.root = nullptr;
+    other.count = 0;
+    other.filter = nullptr;
+    other.log = nullptr;
     return *this;
 }
 
+// Build a balanced tree from sorted values
+BinaryTree BinaryTree::fromSorted(const std::vector<int>& values, unsigned threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    BinaryTree result;
+    if (values.size() <= InlineSortedArray::kCapacity) {
+        for (size_t i = 0; i < values.size(); i++) {
+            result.small_values.pushBack(values[i]);
+        }
+    }
+    else {
+        result.root = _buildBalanced(values.data(), values.size(), threads > 1 ? threads - 1 : 0);
+    }
+    result.count = values.size();
+    return result;
+}
+
+// Replace the values, keeping the settings of the tree
+void BinaryTree::assignSorted(const std::vector<int>& values, unsigned threads) {
+    BinaryTree built = fromSorted(values, threads);
+    if (log != nullptr) {
+        log->compact(values);
+    }
+    _destroy(root);
+    small_values = built.small_values;
+    root = built.root;
+    count = built.count;
+    built.root = nullptr;
+    max_count = count;
+    if (filter != nullptr) {
+        enableFilter();
+    }
+}
+
 // Check if the tree is empty
 bool BinaryTree::isEmpty() const {
-    return is_empty_root_flag;
+    return count == 0;
+}
+
+// Number of values in the tree
+size_t BinaryTree::size() const {
+    return count;
 }
 
 // Inserts a value into the tree
 void BinaryTree::insert(int value) {
-    if (isEmpty()) {
-        data = value;
-        is_empty_root_flag = false; // It's no longer an empty root
+    if (root == nullptr && !small_values.full()) {
+        small_values.insert(value);
     }
     else {
-        if (value < this->data) {
-            this->left = _insert(this->left, value);
+        if (root == nullptr) {
+            _promote();
+        }
+        if (balance_alpha > 0) {
+            _insertBalanced(value);
+        } else {
+            root = _insert(root, value);
         }
-        else if (value >= this->data) {
-            this->right = _insert(this->right, value);
+    }
+    count++;
+    if (filter != nullptr) {
+        if (filter->needsResize()) {
+            // Rebuild with room to grow so the false positive rate stays low
+            enableFilter(2 * count);
+        } else {
+            filter->insert(value);
         }
     }
+    if (log != nullptr) {
+        log->logInsert(value);
+    }
 }
 
 // Search for a value in the tree
@@ -232,7 +578,91 @@ bool BinaryTree::search(int value) const {
     if (isEmpty()) {
         return false;
     }
-    return _search(this, value); // recursive search
+    if (root == nullptr) {
+        return small_values.contains(value); // cheaper than asking the filter
+    }
+    if (filter != nullptr && !filter->mayContain(value)) {
+        return false;
+    }
+    bool found = access_mode == AccessMode::Plain ? _search(root, value) // recursive search
+                                                  : _searchAndAdjust(value);
+    if (!found && filter != nullptr) {
+        filter->recordFalsePositive();
+    }
+    return found;
+}
+
+// Search for many values at once
+// Asynchronous memory access chaining (AMAC): a small ring of lookup states is advanced
+// round robin, one tree level per turn, prefetching the node each lookup will read next.
+void BinaryTree::searchMany(const std::vector<int>& keys, std::vector<bool>& out) const {
+    out.assign(keys.size(), false);
+    if (isEmpty()) {
+        return;
+    }
+    if (root == nullptr) {
+        for (size_t i = 0; i < keys.size(); i++) {
+            out[i] = small_values.contains(keys[i]);
+        }
+        return;
+    }
+
+    struct Lookup {
+        size_t index;      // position in keys
+        const Node* node;  // next node to compare against, nullptr when the slot is idle
+    };
+    Lookup ring[kLookupsInFlight];
+    size_t next_key = 0;
+    size_t active = 0;
+
+    // Starts the next lookup the filter does not reject, returns false when keys run out
+    auto refill = [&](Lookup& lookup) -> bool {
+        while (next_key < keys.size()) {
+            size_t index = next_key++;
+            if (filter != nullptr && !filter->mayContain(keys[index])) {
+                continue;
+            }
+            lookup.index = index;
+            lookup.node = root;
+            return true;
+        }
+        lookup.node = nullptr;
+        return false;
+    };
+
+    for (size_t i = 0; i < kLookupsInFlight; i++) {
+        if (refill(ring[i])) {
+            active++;
+        }
+    }
+    while (active > 0) {
+        for (size_t i = 0; i < kLookupsInFlight; i++) {
+            Lookup& lookup = ring[i];
+            if (lookup.node == nullptr) {
+                continue;
+            }
+            int key = keys[lookup.index];
+            const Node* node = lookup.node;
+            const Node* next;
+            if (node->data == key) {
+                out[lookup.index] = true;
+                next = nullptr;
+            }
+            else {
+                next = key < node->data ? node->left : node->right;
+                if (next == nullptr && filter != nullptr) {
+                    filter->recordFalsePositive();
+                }
+            }
+            if (next != nullptr) {
+                PREFETCH(next);
+                lookup.node = next;
+            }
+            else if (!refill(lookup)) {
+                active--;
+            }
+        }
+    }
 }
 
 // Print tree elements in-order
@@ -241,8 +671,53 @@ void BinaryTree::printInOrder() const {
         std::cout << "Tree is empty.\n";
         return;
     }
-    _printInOrder(this); // recursive print
-    std::cout << std::endl;
+    std::cout << *this << std::endl;
+}
+
+// Append the values in ascending order
+void BinaryTree::appendInOrder(std::vector<int>& out) const {
+    out.insert(out.end(), small_values.begin(), small_values.end());
+    _collectInOrder(root, out);
+}
+
+// Append the values in [low, high] in ascending order
+// Same walk as _collectInOrder, but left subtrees below low are never entered
+// and the walk stops at the first value above high
+void BinaryTree::appendRange(int low, int high, std::vector<int>& out, size_t limit) const {
+    if (root == nullptr) {
+        for (size_t i = small_values.lowerBound(low); i < small_values.size() && limit > 0; i++, limit--) {
+            if (small_values[i] > high) {
+                return;
+            }
+            out.push_back(small_values[i]);
+        }
+        return;
+    }
+    std::vector<const Node*> stack;
+    const Node* node = root;
+    size_t added = 0;
+    while (added < limit) {
+        while (node != nullptr) {
+            if (node->data < low) {
+                node = node->right;
+            }
+            else {
+                stack.push_back(node);
+                node = node->left;
+            }
+        }
+        if (stack.empty()) {
+            return;
+        }
+        node = stack.back();
+        stack.pop_back();
+        if (node->data > high) {
+            return;
+        }
+        out.push_back(node->data);
+        added++;
+        node = node->right;
+    }
 }
 
 // Get the minimum value in the tree
@@ -250,7 +725,10 @@ int BinaryTree::getMinValue() const {
     if (isEmpty()) {
         throw std::runtime_error("Attempted to get min value from an empty tree.");
     }
-    return _getMinValue(this); // recursive min value search
+    if (root == nullptr) {
+        return small_values.front();
+    }
+    return _getMinValue(root); // recursive min value search
 }
 
 // Get the maximum value in the tree
@@ -258,7 +736,10 @@ int BinaryTree::getMaxValue() const {
     if (isEmpty()) {
         throw std::runtime_error("Attempted to get max value from an empty tree.");
     }
-    return _getMaxValue(this); // recursive max value search
+    if (root == nullptr) {
+        return small_values.back();
+    }
+    return _getMaxValue(root); // recursive max value search
 }
 
 // Remove a value from the tree.
@@ -266,57 +747,186 @@ void BinaryTree::remove(int value) {
     if (isEmpty()) {
         throw std::runtime_error("Attempted to remove value from an empty tree.");
     }
+    bool removed = false;
+    if (root == nullptr) {
+        removed = small_values.removeOne(value);
+    }
+    else {
+        root = _remove(root, value, removed);
+    }
+    if (!removed) {
+        throw std::runtime_error("Value not found in tree for removal.");
+    }
+    if (count > max_count) {
+        max_count = count;
+    }
+    count--;
+    if (root != nullptr && count <= kDemoteSize) {
+        _demote();
+    }
+    else if (root != nullptr && balance_alpha > 0 && count < balance_alpha * max_count) {
+        _rebuild(&root, count);
+        max_count = count;
+    }
+    if (filter != nullptr) {
+        filter->remove(value);
+    }
+    if (log != nullptr) {
+        log->logRemove(value);
+    }
+}
 
-    if (this->data == value) {
-        // If no children the tree becomes empty
-        if (this->left == nullptr && this->right == nullptr) {
-            this->is_empty_root_flag = true;
-            this->data = 0; // Default
-            return;
-        }
-        // If one child
-        else if (this->left == nullptr) {
-            BinaryTree* temp = this->right;
-            // Transfer data and children from right child to current root
-            this->data = temp->data;
-            this->left = temp->left;
-            this->right = temp->right;
-            temp->left = nullptr;
-            temp->right = nullptr;
-            delete temp;
-            return;
+// Attach (or rebuild) the membership filter
+void BinaryTree::enableFilter(size_t expected_keys) {
+    CountingBloomFilter* rebuilt = new CountingBloomFilter(expected_keys > 0 ? expected_keys : count);
+    for (const int* value = small_values.begin(); value != small_values.end(); value++) {
+        rebuilt->insert(*value);
+    }
+    _fillFilter(root, *rebuilt);
+    delete filter;
+    filter = rebuilt;
+}
+
+// Detach the membership filter
+void BinaryTree::disableFilter() {
+    delete filter;
+    filter = nullptr;
+}
+
+// Check if a membership filter is attached
+bool BinaryTree::hasFilter() const {
+    return filter != nullptr;
+}
+
+// Attach the write-ahead log
+void BinaryTree::attachLog(OperationLog* target) {
+    log = target;
+}
+
+// Detach the write-ahead log
+void BinaryTree::detachLog() {
+    log = nullptr;
+}
+
+// Select how search restructures the tree
+void BinaryTree::setAccessMode(AccessMode mode, unsigned sample_period) {
+    if (sample_period == 0) {
+        throw std::invalid_argument("Access sample period must be at least 1.");
+    }
+    if (mode != AccessMode::Plain && balance_alpha > 0) {
+        throw std::invalid_argument("Self-adjusting access cannot be combined with shape maintenance.");
+    }
+    access_mode = mode;
+    access_sample_period = sample_period;
+}
+
+BinaryTree::AccessMode BinaryTree::getAccessMode() const {
+    return access_mode;
+}
+
+// Shape maintenance
+void BinaryTree::setBalance(double alpha) {
+    if (alpha != 0 && !(alpha > 0.5 && alpha < 1)) {
+        throw std::invalid_argument("Balance alpha must be 0 or in (0.5, 1).");
+    }
+    if (alpha > 0 && access_mode != AccessMode::Plain) {
+        throw std::invalid_argument("Shape maintenance cannot be combined with self-adjusting access.");
+    }
+    balance_alpha = alpha;
+    if (alpha > 0 && root != nullptr) {
+        _rebuild(&root, count);
+    }
+    max_count = count;
+}
+
+double BinaryTree::getBalance() const {
+    return balance_alpha;
+}
+
+// Shape diagnostics
+size_t BinaryTree::height() const {
+    return depthHistogram().size();
+}
+
+std::vector<size_t> BinaryTree::depthHistogram() const {
+    std::vector<size_t> histogram;
+    std::vector<std::pair<const Node*, size_t> > pending;
+    if (root != nullptr) {
+        pending.push_back(std::make_pair(root, 0));
+    }
+    while (!pending.empty()) {
+        const Node* node = pending.back().first;
+        size_t depth = pending.back().second;
+        pending.pop_back();
+        if (depth == histogram.size()) {
+            histogram.push_back(0);
         }
-        else if (this->right == nullptr) {
-            BinaryTree* temp = this->left;
-            // Transfer data and children from left child to current root
-            this->data = temp->data;
-            this->left = temp->left;
-            this->right = temp->right;
-            temp->left = nullptr;
-            temp->right = nullptr;
-            delete temp;
-            return;
+        histogram[depth]++;
+        if (node->left != nullptr) {
+            pending.push_back(std::make_pair(node->left, depth + 1));
         }
-        // If two children
-        else {
-            BinaryTree* temp = _findMinNode(this->right);
-            this->data = temp->data;
-            this->right = _remove(this->right, temp->data);
-            return;
+        if (node->right != nullptr) {
+            pending.push_back(std::make_pair(node->right, depth + 1));
         }
     }
+    return histogram;
+}
+
+unsigned long long BinaryTree::rebuildCount() const {
+    return rebuilds;
+}
 
-    // If the value is not the root
-    if (value < this->data) {
-        this->left = _remove(this->left, value);
+void BinaryTree::printShape(std::ostream& os) const {
+    std::vector<size_t> histogram = depthHistogram();
+    os << "BinaryTree shape: size=" << count << " height=" << histogram.size();
+    if (count > 0) {
+        os << " optimal_height=" << static_cast<size_t>(std::log2(static_cast<double>(count))) + 1;
     }
-    else if (value > this->data) {
-        this->right = _remove(this->right, value);
+    if (balance_alpha > 0 && count > 0) {
+        os << " alpha_bound=" << static_cast<size_t>(std::log(static_cast<double>(count)) / std::log(1 / balance_alpha)) + 1;
     }
-    // Check if the value was actually removed by the _remove helper
-    if (search(value)) {
-        throw std::runtime_error("Value not found in tree for removal.");
+    os << "\n";
+    for (size_t depth = 0; depth < histogram.size(); depth++) {
+        os << "  depth " << depth << ": " << histogram[depth] << "\n";
+    }
+}
+
+// Set algebra
+BinaryTree BinaryTree::unionWith(const BinaryTree& other) const {
+    return _setOperation(other, SetOperation::Union);
+}
+
+BinaryTree BinaryTree::intersect(const BinaryTree& other) const {
+    return _setOperation(other, SetOperation::Intersection);
+}
+
+BinaryTree BinaryTree::difference(const BinaryTree& other) const {
+    return _setOperation(other, SetOperation::Difference);
+}
+
+BinaryTree BinaryTree::symmetricDifference(const BinaryTree& other) const {
+    return _setOperation(other, SetOperation::SymmetricDifference);
+}
+
+// Print the tree statistics
+void BinaryTree::printStats(std::ostream& os) const {
+    os << "BinaryTree: size=" << count;
+    if (root == nullptr) {
+        os << " storage=inline";
+    } else {
+        os << " storage=nodes node_bytes=" << count * sizeof(Node);
+    }
+    if (access_mode != AccessMode::Plain) {
+        os << " access_hits=" << access_hits << " rotations=" << rotations;
+    }
+    if (balance_alpha > 0) {
+        os << " balance_alpha=" << balance_alpha << " rebuilds=" << rebuilds << " rebuilt_nodes=" << rebuilt_nodes;
     }
+    if (filter != nullptr) {
+        os << " ";
+        filter->printStats(os);
+    }
+    os << "\n";
 }
 
 // --- Operators ---
@@ -331,8 +941,12 @@ BinaryTree& BinaryTree::operator+=(int value) {
 std::ostream& operator<<(std::ostream& os, const BinaryTree& tree) {
     if (tree.isEmpty()) {
         os << "Tree is empty.";
+    } else if (tree.root == nullptr) {
+        for (const int* value = tree.small_values.begin(); value != tree.small_values.end(); value++) {
+            os << *value << " ";
+        }
     } else {
-        tree._printInOrder(&tree); // Start recursive printing
+        tree._printInOrder(tree.root, os); // Start recursive printing
     }
     return os;
-}
\ No newline at end of file
+}
@@ -6,49 +6,126 @@ Author: Adar Shapira, ID: 209580208
 #ifndef BINARY_SEARCH_TREE_H
 #define BINARY_SEARCH_TREE_H
 
+#include <cstddef>
+#include "InlineSortedArray.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <vector>
 
 class BinaryTree;
+class CountingBloomFilter;
+class OperationLog;
+enum class SetOperation;
 
 // Forward declaration of operator<< for friend declaration
 std::ostream& operator<<(std::ostream& os, const BinaryTree& tree);
 
 class BinaryTree {
+public:
+    // How search reorganizes the tree on a hit.
+    enum class AccessMode {
+        Plain,      // searching never changes the tree
+        SemiSplay,  // semi-splay the found node toward the root (roughly halves its depth)
+        MoveToRoot  // rotate the found node all the way to the root
+    };
+
 private:
-    int data;
-    BinaryTree* left;
-    BinaryTree* right;
-    bool is_empty_root_flag;
+    // A single tree node. Per-tree state lives in BinaryTree itself so nodes stay small.
+    struct Node {
+        int data;
+        Node* left;
+        Node* right;
+
+        Node(int val);
+    };
+
+    // Small trees keep their values in small_values and have no nodes (root == nullptr).
+    // Inserting past the inline capacity moves the values into nodes; removing down to
+    // kDemoteSize moves them back, so a size oscillating around the capacity does not thrash.
+    static const size_t kDemoteSize = InlineSortedArray::kCapacity / 2;
+    InlineSortedArray small_values;
+
+    // Searches in a self-adjusting mode rotate nodes, so the shape is mutable even through const
+    mutable Node* root;
+    size_t count;
+    CountingBloomFilter* filter; // optional membership filter, nullptr when disabled
+    OperationLog* log;           // optional write-ahead log (not owned), nullptr when detached
+
+    AccessMode access_mode;
+    unsigned access_sample_period;              // adjust on one hit out of this many
+    mutable unsigned long long access_hits;
+    mutable unsigned long long rotations;
+    mutable std::vector<Node**> access_path;    // links from the root to the searched node, reused between searches
 
-    // Private helper constructor for creating new nodes in _insert, _copy, and _remove
-    BinaryTree(int val);
+    double balance_alpha;                        // 0: no shape maintenance (see setBalance)
+    size_t max_count;                            // largest size since the last full rebuild
+    unsigned long long rebuilds;
+    unsigned long long rebuilt_nodes;
 
     // Helper function for recursive insertion
-    BinaryTree* _insert(BinaryTree* node, int value);
+    Node* _insert(Node* node, int value);
 
     // Helper function for recursive search
-    bool _search(const BinaryTree* node, int value) const;
+    bool _search(const Node* node, int value) const;
 
     // Helper function for recursive in-order printing
-    void _printInOrder(const BinaryTree* node) const;
+    void _printInOrder(const Node* node, std::ostream& os) const;
 
     // Helper function to find minimum value recursively
-    int _getMinValue(const BinaryTree* node) const;
+    int _getMinValue(const Node* node) const;
 
     // Helper function to find maximum value recursively
-    int _getMaxValue(const BinaryTree* node) const;
+    int _getMaxValue(const Node* node) const;
 
     // Helper function for deep copy (used in copy constructor/assignment)
-    BinaryTree* _copy(const BinaryTree* other_node);
+    Node* _copy(const Node* other_node);
 
     // Helper function for destructor (post-order traversal for deletion)
-    void _destroy(BinaryTree* node);
+    void _destroy(Node* node);
 
     // Helper function for recursive removal
-    BinaryTree* _remove(BinaryTree* node, int value);
+    Node* _remove(Node* node, int value, bool& removed_flag);
 
     // Helper function to find the node with the minimum value in a subtree
-    BinaryTree* _findMinNode(BinaryTree* node);
+    Node* _findMinNode(Node* node);
+
+    // Helper function to add every value of a subtree to the membership filter
+    void _fillFilter(const Node* node, CountingBloomFilter& target) const;
+
+    // Helper function to rotate the child of *link up into its parent's place
+    void _rotateUp(Node** link, Node* child) const;
+
+    // Helper function for search in a self-adjusting mode (walks iteratively, then restructures)
+    bool _searchAndAdjust(int value) const;
+
+    // Helper function to append the values in ascending order (iterative, safe for degenerate trees)
+    void _collectInOrder(const Node* node, std::vector<int>& out) const;
+
+    // Helper function to build a balanced subtree from sorted values, using up to spare_threads extra threads
+    static Node* _buildBalanced(const int* values, size_t size, unsigned spare_threads);
+
+    // Helper function for insert with shape maintenance (iterative, rebuilds the scapegoat subtree)
+    void _insertBalanced(int value);
+
+    // Helper function to rebuild the subtree at *link (size nodes) perfectly balanced, in place
+    void _rebuild(Node** link, size_t size);
+
+    // Helper functions to move the values from the inline array into nodes and back
+    void _promote();
+    void _demote();
+
+    // Helper function for the set operations
+    BinaryTree _setOperation(const BinaryTree& other, SetOperation op) const;
+
+    // Trees smaller than this are traversed on the calling thread by the parallel traversals
+    static const size_t kParallelWalkThreshold = 1 << 14;
+
+    // Helper for the parallel traversals (defined below the class)
+    template <typename State, typename Visit, typename Done>
+    struct ParallelWalk;
 
 public:
     // Constructor
@@ -60,19 +137,51 @@ public:
     BinaryTree(const BinaryTree& other);
     BinaryTree& operator=(const BinaryTree& other);
 
+    // Move Constructor and Assignment Operator (take over the nodes of other, leaving it empty)
+    BinaryTree(BinaryTree&& other) noexcept;
+    BinaryTree& operator=(BinaryTree&& other);
+
+    // Builds a balanced tree from values sorted in ascending order, using up to
+    // threads threads (0: every hardware thread).
+    static BinaryTree fromSorted(const std::vector<int>& values, unsigned threads = 0);
+
+    // Replaces the values with values sorted in ascending order, built as fromSorted does, but
+    // keeps the settings of this tree (access mode, shape maintenance, filter, log). An attached
+    // log gets the new values as a snapshot, as with assignment.
+    void assignSorted(const std::vector<int>& values, unsigned threads = 0);
+
     // Public Members
-    // Returns true if the tree (or this node representing the tree) is empty.
+    // Returns true if the tree is empty.
     bool isEmpty() const;
 
+    // Returns the number of values stored in the tree.
+    size_t size() const;
+
     // Inserts a new element to the tree
     void insert(int value);
 
     // Returns true if the element exists in the tree, false otherwise.
+    // Although const, search rotates nodes in a self-adjusting access mode and updates the
+    // statistics of an attached filter, so it is only safe to call from several threads at
+    // once with AccessMode::Plain and no filter.
     bool search(int value) const;
 
+    // Looks up every value of keys and stores the answers in out (out[i] is search(keys[i])).
+    // The lookups are interleaved: each one advances a level, prefetches its next node and
+    // yields to the next lookup, so many cache misses are in flight at once. Never restructures
+    // the tree, even in a self-adjusting access mode, but updates the filter statistics as search does.
+    void searchMany(const std::vector<int>& keys, std::vector<bool>& out) const;
+
     // Prints the values in ascending order (in-order traversal).
     void printInOrder() const;
 
+    // Appends the values in ascending order to out.
+    void appendInOrder(std::vector<int>& out) const;
+
+    // Appends the values in [low, high] in ascending order to out, at most limit of them.
+    // Only the subtrees that overlap the range are visited.
+    void appendRange(int low, int high, std::vector<int>& out, size_t limit = SIZE_MAX) const;
+
     // Returns the minimum value in the tree. Throws std::runtime_error if tree is empty.
     int getMinValue() const;
 
@@ -82,6 +191,88 @@ public:
     // Removes a value from the tree. Throws std::runtime_error if tree is empty or value not found.
     void remove(int value);
 
+    // Membership filter
+    // Attaches a counting Bloom filter so most searches for missing values return
+    // without walking the tree. expected_keys sizes the filter (0: use the current size);
+    // the filter is rebuilt larger when the tree outgrows it.
+    void enableFilter(size_t expected_keys = 0);
+    // Detaches and frees the membership filter.
+    void disableFilter();
+    // Returns true if a membership filter is attached.
+    bool hasFilter() const;
+
+    // Write-ahead log
+    // Appends every successful insert and remove to log, which must outlive the
+    // attachment. Copies of the tree are not attached; a moved tree keeps the log.
+    // Assigning to an attached tree keeps its log and writes the new values to it as a
+    // snapshot (OperationLog::compact), so the assignment may throw its I/O errors.
+    void attachLog(OperationLog* log);
+    // Stops logging.
+    void detachLog();
+
+    // Self-adjusting access
+    // Selects how search restructures the tree on a hit. With sample_period > 1 only
+    // one hit in sample_period restructures, which limits the extra pointer writes.
+    // Search-time rotations would void the height bound of setBalance, so a mode other than
+    // Plain throws std::invalid_argument while shape maintenance is on (and vice versa).
+    void setAccessMode(AccessMode mode, unsigned sample_period = 1);
+    AccessMode getAccessMode() const;
+
+    // Shape maintenance (scapegoat style, no per-node balance data)
+    // With 0.5 < alpha < 1, an insert that lands deeper than log(n) / log(1 / alpha) rebuilds
+    // the subtree of its lowest ancestor holding a child with more than alpha of its nodes,
+    // and a remove that leaves fewer than alpha times the largest size since the last full
+    // rebuild rebuilds the whole tree. Rebuilds relink the existing nodes in linear time,
+    // which keeps insert and remove O(log n) amortized. Enabling rebuilds the current tree;
+    // alpha == 0 turns it off (the default). Throws std::invalid_argument for other values,
+    // and for alpha > 0 while an access mode other than Plain is set.
+    void setBalance(double alpha);
+    double getBalance() const;
+
+    // Shape diagnostics, each O(n). An inline tree has no nodes, so height 0 and no depths.
+    // Returns the number of nodes on the longest path from the root.
+    size_t height() const;
+    // Returns the number of nodes at every depth (index 0: the root).
+    std::vector<size_t> depthHistogram() const;
+    // Returns the number of subtree rebuilds done by shape maintenance.
+    unsigned long long rebuildCount() const;
+    // Prints the height, the alpha height bound and the depth histogram.
+    void printShape(std::ostream& os = std::cout) const;
+
+    // Set algebra over the distinct values of two trees. Each returns a new balanced
+    // tree holding every value once; large inputs are merged on several threads. An
+    // intersection with a much smaller tree, or the difference of a much smaller tree and a
+    // large one, looks the smaller tree's values up in the larger one instead (O(m log n)).
+    BinaryTree unionWith(const BinaryTree& other) const;
+    BinaryTree intersect(const BinaryTree& other) const;
+    BinaryTree difference(const BinaryTree& other) const;
+    BinaryTree symmetricDifference(const BinaryTree& other) const;
+
+    // Parallel traversal
+    // These run on the threads of pool. The work is split by subtree and idle threads steal
+    // it; trees below kParallelWalkThreshold values are walked on the calling thread. fn, map,
+    // combine and pred are called from several threads at once and must not modify the tree
+    // (see search for when a search counts as a modification).
+    //
+    // Calls fn(value) for every value, in no particular order.
+    template <typename Fn>
+    void parallelForEach(Fn fn, ThreadPool& pool = ThreadPool::shared()) const;
+    // Returns identity combined with map(value) for every value. combine must be associative
+    // and commutative: partial results are combined in whatever order the threads finish.
+    template <typename T, typename Map, typename Combine>
+    T parallelReduce(const T& identity, Map map, Combine combine, ThreadPool& pool = ThreadPool::shared()) const;
+    // Same, but combine only has to be associative: values and partial results are combined
+    // in ascending order, exactly as a sequential in-order walk would combine them.
+    template <typename T, typename Map, typename Combine>
+    T parallelReduceOrdered(const T& identity, Map map, Combine combine,
+                            ThreadPool& pool = ThreadPool::shared()) const;
+    // Returns the number of values for which pred(value) is true.
+    template <typename Pred>
+    size_t parallelCountIf(Pred pred, ThreadPool& pool = ThreadPool::shared()) const;
+
+    // Prints the size of the tree and the filter statistics.
+    void printStats(std::ostream& os = std::cout) const;
+
     // Operators
     // Adds a value to the tree (uses insert function).
     BinaryTree& operator+=(int value);
@@ -89,4 +280,153 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const BinaryTree& tree);
 };
 
-#endif // BINARY_SEARCH_TREE_H
\ No newline at end of file
+
+// --- Parallel traversal ---
+
+// One parallel traversal. The in-order sequence of values is cut into segments, each with its
+// own partial State, linked in key order. A task walks in order with an explicit stack of
+// pending ancestors (each still owes its own value and then its right subtree). Every
+// kSplitCheckInterval values it checks whether a thread is idle and, if so, hands the bottom
+// of its stack, up to the shallowest ancestor with a right subtree, to a new task: that is the
+// largest piece it has left and the end of its key range, so the new segment is linked right
+// after its own and the order is kept.
+template <typename State, typename Visit, typename Done>
+struct BinaryTree::ParallelWalk {
+    struct Segment {
+        State state;
+        Segment* next;
+
+        Segment(const State& state) : state(state), next(nullptr) {}
+    };
+
+    static const unsigned kSplitCheckInterval = 256;
+
+    ThreadPool& pool;
+    State identity;
+    Visit visit;                    // visit(State&, int) for every value of a segment, in order
+    Done done;                      // done(State&) once a segment is complete
+    bool parallel;                  // false: everything runs on the calling thread
+    std::mutex segments_mutex;
+    std::deque<Segment> segments;   // a deque never moves its elements
+
+    ParallelWalk(ThreadPool& pool, const State& identity, Visit visit, Done done)
+        : pool(pool), identity(identity), visit(visit), done(done), parallel(false) {}
+
+    // Creates a segment linked right after after (nullptr: the first segment)
+    Segment* newSegment(Segment* after) {
+        Segment* segment;
+        {
+            std::lock_guard<std::mutex> lock(segments_mutex);
+            segments.push_back(Segment(identity));
+            segment = &segments.back();
+        }
+        if (after != nullptr) {
+            segment->next = after->next;
+            after->next = segment;
+        }
+        return segment;
+    }
+
+    // Walks the subtree at node and then the pending ancestors of stack into segment,
+    // splitting off work while threads are idle
+    void walk(std::vector<const Node*> stack, const Node* node, Segment* segment) {
+        size_t base = 0; // stack entries below this index were handed to other tasks
+        unsigned until_check = kSplitCheckInterval;
+        for (;;) {
+            while (node != nullptr) {
+                stack.push_back(node);
+                node = node->left;
+            }
+            if (stack.size() == base) {
+                break;
+            }
+            const Node* current = stack.back();
+            stack.pop_back();
+            visit(segment->state, current->data);
+            node = current->right;
+
+            if (parallel && --until_check == 0) {
+                until_check = kSplitCheckInterval;
+                size_t last = base;
+                while (last < stack.size() && stack[last]->right == nullptr) {
+                    last++;
+                }
+                if (last < stack.size() && pool.wantsWork()) {
+                    std::vector<const Node*> piece(stack.begin() + base, stack.begin() + last + 1);
+                    base = last + 1;
+                    Segment* piece_segment = newSegment(segment);
+                    pool.spawn([this, piece, piece_segment] { walk(piece, nullptr, piece_segment); });
+                }
+            }
+        }
+        done(segment->state);
+    }
+
+    // Walks the whole tree and returns the first segment
+    Segment* run(const BinaryTree& tree) {
+        Segment* first = newSegment(nullptr);
+        if (tree.root == nullptr) {
+            for (const int* value = tree.small_values.begin(); value != tree.small_values.end(); value++) {
+                visit(first->state, *value);
+            }
+            done(first->state);
+        }
+        else if (tree.count < kParallelWalkThreshold || pool.size() == 1) {
+            walk(std::vector<const Node*>(), tree.root, first);
+        }
+        else {
+            parallel = true;
+            const Node* root = tree.root;
+            pool.run([this, root, first] { walk(std::vector<const Node*>(), root, first); });
+        }
+        return first;
+    }
+};
+
+template <typename Fn>
+void BinaryTree::parallelForEach(Fn fn, ThreadPool& pool) const {
+    struct Nothing {};
+    auto visit = [&fn](Nothing&, int value) { fn(value); };
+    auto done = [](Nothing&) {};
+    ParallelWalk<Nothing, decltype(visit), decltype(done)> walk(pool, Nothing(), visit, done);
+    walk.run(*this);
+}
+
+template <typename T, typename Map, typename Combine>
+T BinaryTree::parallelReduce(const T& identity, Map map, Combine combine, ThreadPool& pool) const {
+    // One partial per pool thread (plus the caller when it is not one), each touched by its thread only
+    std::vector<T> partials(pool.size() + 1, identity);
+    auto visit = [&](T& state, int value) { state = combine(state, map(value)); };
+    auto done = [&](T& state) {
+        T& partial = partials[pool.currentThread()];
+        partial = combine(partial, state);
+    };
+    ParallelWalk<T, decltype(visit), decltype(done)> walk(pool, identity, visit, done);
+    walk.run(*this);
+    T result = identity;
+    for (size_t i = 0; i < partials.size(); i++) {
+        result = combine(result, partials[i]);
+    }
+    return result;
+}
+
+template <typename T, typename Map, typename Combine>
+T BinaryTree::parallelReduceOrdered(const T& identity, Map map, Combine combine, ThreadPool& pool) const {
+    auto visit = [&](T& state, int value) { state = combine(state, map(value)); };
+    auto done = [](T&) {};
+    typedef ParallelWalk<T, decltype(visit), decltype(done)> Walk;
+    Walk walk(pool, identity, visit, done);
+    T result = identity;
+    for (const typename Walk::Segment* segment = walk.run(*this); segment != nullptr; segment = segment->next) {
+        result = combine(result, segment->state);
+    }
+    return result;
+}
+
+template <typename Pred>
+size_t BinaryTree::parallelCountIf(Pred pred, ThreadPool& pool) const {
+    return parallelReduce(size_t(0), [&pred](int value) -> size_t { return pred(value) ? 1 : 0; },
+                          [](size_t a, size_t b) { return a + b; }, pool);
+}
+
+#endif // BINARY_SEARCH_TREE_H
@@ -0,0 +1,165 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "BloomFilter.h"
+#include <cmath>
+
+// Mixes the bits of a 64-bit value (murmur3 finalizer)
+static uint64_t mix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDULL;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+// --- Private Helper Functions ---
+
+// Helper to allocate zeroed, cache-line aligned blocks
+void CountingBloomFilter::_allocate(size_t block_count) {
+    num_blocks = block_count;
+    storage.assign(num_blocks * kWordsPerBlock + kWordsPerBlock, 0);
+    uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+    uintptr_t aligned = (address + 63) & ~static_cast<uintptr_t>(63);
+    blocks = reinterpret_cast<uint64_t*>(aligned);
+}
+
+// Helper to find the first word of a key's block and the hash used for its probes
+size_t CountingBloomFilter::_blockOffset(int key, uint64_t& probe_hash) const {
+    uint64_t hash = mix64(static_cast<uint32_t>(key));
+    // Map the high half of the hash onto [0, num_blocks) without a division
+    size_t index = static_cast<size_t>(((hash >> 32) * num_blocks) >> 32);
+    probe_hash = mix64(hash);
+    return index * kWordsPerBlock;
+}
+
+// --- Public Member Functions ---
+
+CountingBloomFilter::CountingBloomFilter(size_t expected_keys)
+    : blocks(nullptr), num_blocks(0), capacity(expected_keys), key_count(0),
+      lookups(0), rejections(0), false_positives(0) {
+    size_t counters = expected_keys * kCountersPerKey;
+    size_t block_count = (counters + kCountersPerBlock - 1) / kCountersPerBlock;
+    _allocate(block_count > 0 ? block_count : 1);
+}
+
+CountingBloomFilter::CountingBloomFilter(const CountingBloomFilter& other)
+    : blocks(nullptr), num_blocks(0), capacity(other.capacity), key_count(other.key_count),
+      lookups(other.lookups), rejections(other.rejections), false_positives(other.false_positives) {
+    _allocate(other.num_blocks);
+    for (size_t i = 0; i < num_blocks * kWordsPerBlock; i++) {
+        blocks[i] = other.blocks[i];
+    }
+}
+
+CountingBloomFilter& CountingBloomFilter::operator=(const CountingBloomFilter& other) {
+    if (this == &other) {
+        return *this;
+    }
+    _allocate(other.num_blocks);
+    for (size_t i = 0; i < num_blocks * kWordsPerBlock; i++) {
+        blocks[i] = other.blocks[i];
+    }
+    capacity = other.capacity;
+    key_count = other.key_count;
+    lookups = other.lookups;
+    rejections = other.rejections;
+    false_positives = other.false_positives;
+    return *this;
+}
+
+void CountingBloomFilter::insert(int key) {
+    uint64_t probe_hash;
+    uint64_t* block = blocks + _blockOffset(key, probe_hash);
+    for (int i = 0; i < kProbes; i++) {
+        unsigned counter = (probe_hash >> (7 * i)) & (kCountersPerBlock - 1);
+        uint64_t& word = block[counter >> 4];
+        unsigned shift = (counter & 15) * 4;
+        if (((word >> shift) & 0xF) < kMaxCounter) {
+            word += 1ULL << shift;
+        }
+    }
+    key_count++;
+}
+
+void CountingBloomFilter::remove(int key) {
+    uint64_t probe_hash;
+    uint64_t* block = blocks + _blockOffset(key, probe_hash);
+    for (int i = 0; i < kProbes; i++) {
+        unsigned counter = (probe_hash >> (7 * i)) & (kCountersPerBlock - 1);
+        uint64_t& word = block[counter >> 4];
+        unsigned shift = (counter & 15) * 4;
+        uint64_t value = (word >> shift) & 0xF;
+        // A saturated counter no longer knows how many keys share it, so it is left alone
+        if (value > 0 && value < kMaxCounter) {
+            word -= 1ULL << shift;
+        }
+    }
+    if (key_count > 0) {
+        key_count--;
+    }
+}
+
+bool CountingBloomFilter::mayContain(int key) const {
+    uint64_t probe_hash;
+    const uint64_t* block = blocks + _blockOffset(key, probe_hash);
+    lookups++;
+    for (int i = 0; i < kProbes; i++) {
+        unsigned counter = (probe_hash >> (7 * i)) & (kCountersPerBlock - 1);
+        if (((block[counter >> 4] >> ((counter & 15) * 4)) & 0xF) == 0) {
+            rejections++;
+            return false;
+        }
+    }
+    return true;
+}
+
+void CountingBloomFilter::recordFalsePositive() const {
+    false_positives++;
+}
+
+// Past the sized capacity the ~1% false positive rate of kCountersPerKey no longer holds
+bool CountingBloomFilter::needsResize() const {
+    return key_count > capacity;
+}
+
+void CountingBloomFilter::clear() {
+    for (size_t i = 0; i < storage.size(); i++) {
+        storage[i] = 0;
+    }
+    key_count = 0;
+}
+
+size_t CountingBloomFilter::size() const {
+    return key_count;
+}
+
+size_t CountingBloomFilter::memoryBytes() const {
+    return sizeof(*this) + storage.capacity() * sizeof(uint64_t);
+}
+
+double CountingBloomFilter::estimatedFalsePositiveRate() const {
+    double counters = static_cast<double>(num_blocks) * kCountersPerBlock;
+    double fill = 1.0 - std::exp(-kProbes * static_cast<double>(key_count) / counters);
+    return std::pow(fill, kProbes);
+}
+
+double CountingBloomFilter::observedFalsePositiveRate() const {
+    uint64_t negatives = rejections + false_positives;
+    if (negatives == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(false_positives) / negatives;
+}
+
+void CountingBloomFilter::printStats(std::ostream& os) const {
+    os << "filter: keys=" << key_count << " capacity=" << capacity
+       << " memory=" << memoryBytes() << "B"
+       << " lookups=" << lookups << " rejected=" << rejections
+       << " false_positives=" << false_positives
+       << " observed_fp_rate=" << observedFalsePositiveRate()
+       << " estimated_fp_rate=" << estimatedFalsePositiveRate();
+}
@@ -0,0 +1,83 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Blocked counting Bloom filter over int keys.
+// Every key maps to one 64-byte block (one cache line) of 128 four-bit counters
+// and sets kProbes of them, so a lookup touches a single cache line. Counters
+// make removal possible; a counter that reaches 15 sticks there, which can only
+// cause extra false positives, never false negatives.
+class CountingBloomFilter {
+private:
+    static const int kCountersPerBlock = 128;
+    static const int kWordsPerBlock = 8;     // 8 x 64-bit words = 64 bytes
+    static const int kProbes = 6;
+    static const int kCountersPerKey = 10;   // ~1% false positives at full capacity
+    static const uint64_t kMaxCounter = 15;
+
+    std::vector<uint64_t> storage;  // over-allocated so blocks can start on a cache line
+    uint64_t* blocks;
+    size_t num_blocks;
+    size_t capacity;                // number of keys the filter was sized for
+    size_t key_count;               // keys currently represented
+
+    // Observed behavior, updated by lookups
+    mutable uint64_t lookups;
+    mutable uint64_t rejections;
+    mutable uint64_t false_positives;
+
+    // Helper to allocate zeroed, cache-line aligned blocks
+    void _allocate(size_t block_count);
+
+    // Helper to find the first word of a key's block and the hash used for its probes
+    size_t _blockOffset(int key, uint64_t& probe_hash) const;
+
+public:
+    // Creates a filter sized for expected_keys keys (at least one block).
+    explicit CountingBloomFilter(size_t expected_keys);
+
+    CountingBloomFilter(const CountingBloomFilter& other);
+    CountingBloomFilter& operator=(const CountingBloomFilter& other);
+
+    // Adds one occurrence of key.
+    void insert(int key);
+
+    // Removes one occurrence of key. Only call this for a key that was inserted.
+    void remove(int key);
+
+    // Returns false if key is definitely absent, true if it may be present.
+    // Counts the lookup in the (unsynchronized) statistics, so concurrent calls race.
+    bool mayContain(int key) const;
+
+    // Called by the owner when mayContain returned true but the key was absent.
+    void recordFalsePositive() const;
+
+    // Returns true once the filter holds so many keys that its false positive rate degrades.
+    bool needsResize() const;
+
+    // Removes every key and resets the counters.
+    void clear();
+
+    size_t size() const;
+    size_t memoryBytes() const;
+
+    // Expected false positive rate for the current number of keys.
+    double estimatedFalsePositiveRate() const;
+
+    // False positives divided by lookups of absent keys seen so far.
+    double observedFalsePositiveRate() const;
+
+    // Prints the filter statistics on one line.
+    void printStats(std::ostream& os) const;
+};
+
+#endif // BLOOM_FILTER_H
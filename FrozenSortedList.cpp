@@ -0,0 +1,363 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "FrozenSortedList.h"
+#include "SetAlgebra.h"
+#include <algorithm>
+#include <stdexcept>
+
+// --- Iterator ---
+
+FrozenSortedList::const_iterator::const_iterator() : list(nullptr), block(0), index(0), block_size(0), value(0) {}
+
+FrozenSortedList::const_iterator::const_iterator(const FrozenSortedList* list, size_t block)
+    : list(list), block(block), index(0), block_size(0), value(0) {
+    if (block < list->block_first.size()) {
+        block_size = list->_block_size(block);
+        value = list->block_first[block];
+    }
+}
+
+const int& FrozenSortedList::const_iterator::operator*() const {
+    return value;
+}
+
+// Steps to the next value: adds the next gap, or moves to the first value of the next block
+FrozenSortedList::const_iterator& FrozenSortedList::const_iterator::operator++() {
+    index++;
+    if (index < block_size) {
+        value = static_cast<int>(static_cast<uint32_t>(value) + list->_delta(block, index));
+        return *this;
+    }
+    *this = const_iterator(list, block + 1);
+    return *this;
+}
+
+FrozenSortedList::const_iterator FrozenSortedList::const_iterator::operator++(int) {
+    const_iterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+bool FrozenSortedList::const_iterator::operator==(const const_iterator& other) const {
+    return block == other.block && index == other.index;
+}
+
+bool FrozenSortedList::const_iterator::operator!=(const const_iterator& other) const {
+    return !(*this == other);
+}
+
+// --- Builder ---
+
+FrozenSortedList::Builder::Builder() : pending(0) {}
+
+void FrozenSortedList::Builder::append(int value) {
+    bool in_order = pending > 0 ? value >= block[pending - 1] : (list.count == 0 || value >= list.last);
+    if (!in_order) {
+        throw std::invalid_argument("FrozenSortedList values must be appended in ascending order.");
+    }
+    block[pending++] = value;
+    if (pending == kBlockSize) {
+        list._encode_block(block, pending);
+        pending = 0;
+    }
+}
+
+FrozenSortedList FrozenSortedList::Builder::finish() {
+    if (pending > 0) {
+        list._encode_block(block, pending);
+        pending = 0;
+    }
+    list.block_first.shrink_to_fit();
+    list.block_offset.shrink_to_fit();
+    list.block_width.shrink_to_fit();
+    list.words.shrink_to_fit();
+    FrozenSortedList result;
+    std::swap(result, list);
+    return result;
+}
+
+// --- Private Helper Functions ---
+
+// Helper to pack a block
+// The gaps of sorted ints always fit in 32 bits, so a gap never spans more than two words
+void FrozenSortedList::_encode_block(const int* values, size_t size) {
+    uint32_t widest = 0;
+    for (size_t i = 1; i < size; i++) {
+        widest |= static_cast<uint32_t>(values[i]) - static_cast<uint32_t>(values[i - 1]);
+    }
+    uint8_t width = 0;
+    while (width < 32 && (widest >> width) != 0) {
+        width++;
+    }
+    block_first.push_back(values[0]);
+    block_offset.push_back(static_cast<uint32_t>(words.size()));
+    block_width.push_back(width);
+
+    size_t start = words.size();
+    words.resize(start + ((size - 1) * width + 63) / 64, 0);
+    for (size_t i = 1; i < size && width > 0; i++) {
+        uint64_t gap = static_cast<uint32_t>(values[i]) - static_cast<uint32_t>(values[i - 1]);
+        size_t bit = (i - 1) * width;
+        size_t word = start + bit / 64;
+        size_t shift = bit % 64;
+        words[word] |= gap << shift;
+        if (shift + width > 64) {
+            words[word + 1] |= gap >> (64 - shift);
+        }
+    }
+    count += size;
+    last = values[size - 1];
+}
+
+// Helper to decode a gap
+uint32_t FrozenSortedList::_delta(size_t block, size_t index) const {
+    uint8_t width = block_width[block];
+    if (width == 0) {
+        return 0;
+    }
+    size_t bit = (index - 1) * width;
+    size_t word = block_offset[block] + bit / 64;
+    size_t shift = bit % 64;
+    uint64_t gap = words[word] >> shift;
+    if (shift + width > 64) {
+        gap |= words[word + 1] << (64 - shift);
+    }
+    return static_cast<uint32_t>(gap & ((uint64_t(1) << width) - 1));
+}
+
+// Helper for the size of a block
+// Every block but the last one is full
+size_t FrozenSortedList::_block_size(size_t block) const {
+    return block + 1 < block_first.size() ? kBlockSize : count - block * kBlockSize;
+}
+
+// Helper to decode a whole block
+// Same unpacking as _delta, with the block fields read once
+void FrozenSortedList::_decode_block(size_t block, int* out) const {
+    size_t size = _block_size(block);
+    uint8_t width = block_width[block];
+    uint32_t value = static_cast<uint32_t>(block_first[block]);
+    out[0] = block_first[block];
+    if (width == 0) {
+        std::fill(out + 1, out + size, out[0]);
+        return;
+    }
+    const uint64_t* packed = words.data() + block_offset[block];
+    uint64_t mask = (uint64_t(1) << width) - 1;
+    size_t bit = 0;
+    for (size_t i = 1; i < size; i++, bit += width) {
+        size_t shift = bit % 64;
+        uint64_t gap = packed[bit / 64] >> shift;
+        if (shift + width > 64) {
+            gap |= packed[bit / 64 + 1] << (64 - shift);
+        }
+        value += static_cast<uint32_t>(gap & mask);
+        out[i] = static_cast<int>(value);
+    }
+}
+
+// Helper to move an iterator forward to value
+// The last block starting below value is the first one that can hold it; the index is only
+// searched when that is not the current block
+void FrozenSortedList::_seek(const_iterator& it, int value) const {
+    if (it.block >= block_first.size() || *it >= value) {
+        return;
+    }
+    if (it.block + 1 < block_first.size() && block_first[it.block + 1] < value) {
+        size_t target = std::lower_bound(block_first.begin() + it.block + 1, block_first.end(), value) -
+                        block_first.begin() - 1;
+        it = const_iterator(this, target);
+    }
+    while (it.block < block_first.size() && *it < value) {
+        ++it;
+    }
+}
+
+// Helper for the set operations
+// Same merge as SortedList::_setOperation, with the iterators skipping what op drops anyway
+FrozenSortedList FrozenSortedList::_set_operation(const FrozenSortedList& other, SetOperation op) const {
+    Builder result;
+    const_iterator first = begin();
+    const_iterator second = other.begin();
+    const_iterator first_end = end();
+    const_iterator second_end = other.end();
+    while (first != first_end || second != second_end) {
+        if (second != second_end && first != first_end && *first < *second && !keepsOnlyFirst(op)) {
+            _seek(first, *second);
+            continue;
+        }
+        if (first != first_end && second != second_end && *second < *first && !keepsOnlySecond(op)) {
+            other._seek(second, *first);
+            continue;
+        }
+        bool in_first = second == second_end || (first != first_end && *first <= *second);
+        bool in_second = first == first_end || (second != second_end && *second <= *first);
+        int value = in_first ? *first : *second;
+        bool keep = in_first && in_second ? keepsBoth(op) : (in_first ? keepsOnlyFirst(op) : keepsOnlySecond(op));
+        if (!keep && ((in_first && second == second_end) || (in_second && first == first_end))) {
+            // Only one list is left and op drops all of it
+            break;
+        }
+        // Skip every copy of the value in both lists
+        while (first != first_end && *first == value) {
+            ++first;
+        }
+        while (second != second_end && *second == value) {
+            ++second;
+        }
+        if (keep) {
+            result.append(value);
+        }
+    }
+    return result.finish();
+}
+
+// --- Public Member Functions ---
+
+// Constructor
+FrozenSortedList::FrozenSortedList() : count(0), last(0) {}
+
+// Pack sorted values
+FrozenSortedList FrozenSortedList::fromSorted(const std::vector<int>& values) {
+    Builder builder;
+    for (size_t i = 0; i < values.size(); i++) {
+        builder.append(values[i]);
+    }
+    return builder.finish();
+}
+
+// Check if the list is empty
+bool FrozenSortedList::isEmpty() const {
+    return count == 0;
+}
+
+// Get the number of values
+size_t FrozenSortedList::size() const {
+    return count;
+}
+
+// Search for a value
+// The skip index picks the only block that can hold value, which is then decoded up to it
+bool FrozenSortedList::search(int value) const {
+    std::vector<int>::const_iterator found = std::lower_bound(block_first.begin(), block_first.end(), value);
+    if (found != block_first.end() && *found == value) {
+        return true;
+    }
+    if (found == block_first.begin()) {
+        return false;
+    }
+    size_t block = found - block_first.begin() - 1;
+    size_t size = _block_size(block);
+    int current = block_first[block];
+    for (size_t i = 1; i < size && current < value; i++) {
+        current = static_cast<int>(static_cast<uint32_t>(current) + _delta(block, i));
+    }
+    return current == value;
+}
+
+// Get the first item
+int FrozenSortedList::getFirst() const {
+    if (isEmpty()) {
+        throw std::out_of_range("Attempted to get first element from an empty list.");
+    }
+    return block_first.front();
+}
+
+// Get the last item
+int FrozenSortedList::getLast() const {
+    if (isEmpty()) {
+        throw std::out_of_range("Attempted to get last element from an empty list.");
+    }
+    return last;
+}
+
+FrozenSortedList::const_iterator FrozenSortedList::begin() const {
+    return const_iterator(this, 0);
+}
+
+FrozenSortedList::const_iterator FrozenSortedList::end() const {
+    return const_iterator(this, block_first.size());
+}
+
+FrozenSortedList::const_iterator FrozenSortedList::lowerBound(int value) const {
+    const_iterator it = begin();
+    _seek(it, value);
+    return it;
+}
+
+// Append the values in ascending order
+void FrozenSortedList::appendInOrder(std::vector<int>& out) const {
+    size_t start = out.size();
+    out.resize(start + count);
+    for (size_t block = 0; block < block_first.size(); block++) {
+        _decode_block(block, out.data() + start + block * kBlockSize);
+    }
+}
+
+// Append the values in [low, high] in ascending order
+void FrozenSortedList::appendRange(int low, int high, std::vector<int>& out, size_t limit) const {
+    for (const_iterator it = lowerBound(low); it != end() && *it <= high && limit > 0; ++it, limit--) {
+        out.push_back(*it);
+    }
+}
+
+// Set algebra
+FrozenSortedList FrozenSortedList::unionWith(const FrozenSortedList& other) const {
+    return _set_operation(other, SetOperation::Union);
+}
+
+FrozenSortedList FrozenSortedList::intersect(const FrozenSortedList& other) const {
+    return _set_operation(other, SetOperation::Intersection);
+}
+
+FrozenSortedList FrozenSortedList::difference(const FrozenSortedList& other) const {
+    return _set_operation(other, SetOperation::Difference);
+}
+
+FrozenSortedList FrozenSortedList::symmetricDifference(const FrozenSortedList& other) const {
+    return _set_operation(other, SetOperation::SymmetricDifference);
+}
+
+// Unpack into a SortedList
+SortedList FrozenSortedList::thaw() const {
+    std::vector<int> values;
+    appendInOrder(values);
+    return SortedList::fromSorted(values);
+}
+
+// Get the memory used
+size_t FrozenSortedList::memoryBytes() const {
+    return sizeof(*this) + block_first.capacity() * sizeof(int) + block_offset.capacity() * sizeof(uint32_t) +
+           block_width.capacity() * sizeof(uint8_t) + words.capacity() * sizeof(uint64_t);
+}
+
+// Print the statistics
+void FrozenSortedList::printStats(std::ostream& os) const {
+    os << "FrozenSortedList: size=" << count << " blocks=" << block_first.size() << " bytes=" << memoryBytes();
+    if (count > 0) {
+        os << " bytes_per_value=" << static_cast<double>(memoryBytes()) / count;
+    }
+    os << "\n";
+}
+
+// --- Operators ---
+
+// Compare two lists value by value
+bool FrozenSortedList::operator==(const FrozenSortedList& other) const {
+    return count == other.count && std::equal(begin(), end(), other.begin());
+}
+
+// Prints the values in ascending order
+std::ostream& operator<<(std::ostream& os, const FrozenSortedList& list) {
+    if (list.isEmpty()) {
+        os << "List is empty.";
+        return os;
+    }
+    for (FrozenSortedList::const_iterator it = list.begin(); it != list.end(); ++it) {
+        os << (it == list.begin() ? "" : ", ") << *it;
+    }
+    return os;
+}
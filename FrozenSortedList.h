@@ -0,0 +1,159 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef FROZEN_SORTED_LIST_H
+#define FROZEN_SORTED_LIST_H
+
+#include "SortedList.h"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+class FrozenSortedList;
+enum class SetOperation;
+
+// Forward declaration of operator<< for friend declaration
+std::ostream& operator<<(std::ostream& os, const FrozenSortedList& list);
+
+// Immutable, compressed form of a SortedList (see SortedList::compact).
+//
+// The values are cut into blocks of kBlockSize. A block stores the gaps between its
+// consecutive values, bit-packed at the width of its largest gap, so a dense range of IDs
+// costs about one bit per value. The first value, bit width and position of every block form
+// a skip index: a search binary-searches the first values and decodes a single block, and
+// iterators jump over whole blocks the same way. Set operations stream over both inputs
+// without decompressing them.
+class FrozenSortedList {
+public:
+    static const size_t kBlockSize = 128;
+
+    // Forward iterator over the values in ascending order, decoding one gap per step.
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int* pointer;
+        typedef const int& reference;
+
+        const_iterator();
+        const int& operator*() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+    private:
+        friend class FrozenSortedList;
+        const FrozenSortedList* list;
+        size_t block;
+        size_t index;       // position inside the block
+        size_t block_size;
+        int value;
+
+        const_iterator(const FrozenSortedList* list, size_t block);
+    };
+
+    // Appends values in ascending order and packs them a block at a time (defined below the class).
+    class Builder;
+
+private:
+    std::vector<int> block_first;        // skip index: first value of every block
+    std::vector<uint32_t> block_offset;  // first word of every block in words
+    std::vector<uint8_t> block_width;    // bits per gap of every block
+    std::vector<uint64_t> words;         // bit-packed gaps, each block starting on a new word
+    size_t count;
+    int last;
+
+    // Helper to pack values (ascending, 1 to kBlockSize of them) as a new block
+    void _encode_block(const int* values, size_t size);
+
+    // Helper to decode the gap before the index-th value of block (index >= 1)
+    uint32_t _delta(size_t block, size_t index) const;
+
+    // Helper returning the number of values in block
+    size_t _block_size(size_t block) const;
+
+    // Helper to decode every value of block into out
+    void _decode_block(size_t block, int* out) const;
+
+    // Helper to advance it to the first value >= value, skipping whole blocks through the index
+    void _seek(const_iterator& it, int value) const;
+
+    // Helper function for the set operations
+    FrozenSortedList _set_operation(const FrozenSortedList& other, SetOperation op) const;
+
+public:
+    // Creates an empty list
+    FrozenSortedList();
+
+    // Packs values sorted in ascending order. Throws std::invalid_argument if they are not.
+    static FrozenSortedList fromSorted(const std::vector<int>& values);
+
+    // Returns true if the list is empty.
+    bool isEmpty() const;
+
+    // Returns the number of values in the list.
+    size_t size() const;
+
+    // Returns true if the value exists in the list. Decodes at most one block.
+    bool search(int value) const;
+
+    // Returns the smallest / largest value. Throws std::out_of_range if the list is empty.
+    int getFirst() const;
+    int getLast() const;
+
+    // Iterators over the values in ascending order; lowerBound points at the first value >= value.
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator lowerBound(int value) const;
+
+    // Appends the values in ascending order to out.
+    void appendInOrder(std::vector<int>& out) const;
+
+    // Appends the values in [low, high] in ascending order to out, at most limit of them.
+    void appendRange(int low, int high, std::vector<int>& out, size_t limit = SIZE_MAX) const;
+
+    // Set algebra over the distinct values of two lists, each returning a new frozen list.
+    // Values of one list that the operation drops unless the other list has them too are
+    // skipped block by block, so intersecting a small list with a big one is cheap.
+    FrozenSortedList unionWith(const FrozenSortedList& other) const;
+    FrozenSortedList intersect(const FrozenSortedList& other) const;
+    FrozenSortedList difference(const FrozenSortedList& other) const;
+    FrozenSortedList symmetricDifference(const FrozenSortedList& other) const;
+
+    // Returns a SortedList holding the same values.
+    SortedList thaw() const;
+
+    // Returns the bytes used by the list, index included.
+    size_t memoryBytes() const;
+
+    // Prints the size, the number of blocks and the memory per value.
+    void printStats(std::ostream& os = std::cout) const;
+
+    // Operators
+    // Returns true if both lists hold the same values.
+    bool operator==(const FrozenSortedList& other) const;
+    // Prints the values in ascending order.
+    friend std::ostream& operator<<(std::ostream& os, const FrozenSortedList& list);
+};
+
+class FrozenSortedList::Builder {
+public:
+    Builder();
+    // Adds value after the others. Throws std::invalid_argument if it is smaller than the last one.
+    void append(int value);
+    // Returns the list; the builder is empty afterwards.
+    FrozenSortedList finish();
+
+private:
+    FrozenSortedList list;
+    int block[kBlockSize];
+    size_t pending;
+};
+
+#endif // FROZEN_SORTED_LIST_H
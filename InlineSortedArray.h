@@ -0,0 +1,94 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef INLINE_SORTED_ARRAY_H
+#define INLINE_SORTED_ARRAY_H
+
+#include <cstddef>
+
+// Fixed-capacity ascending array of ints stored inside its owner: the small-size
+// representation of BinaryTree and SortedList. Up to kCapacity values need no heap
+// allocation and are found with a linear scan of one or two cache lines.
+class InlineSortedArray {
+public:
+    static const size_t kCapacity = 32;
+
+private:
+    int values[kCapacity];
+    unsigned length;
+
+public:
+    InlineSortedArray() : length(0) {}
+
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    bool full() const { return length == kCapacity; }
+    void clear() { length = 0; }
+
+    const int* begin() const { return values; }
+    const int* end() const { return values + length; }
+    int operator[](size_t index) const { return values[index]; }
+    int front() const { return values[0]; }
+    int back() const { return values[length - 1]; }
+
+    // Returns the number of values smaller than value (its insertion point).
+    // Counting without branches lets the compiler vectorize the scan.
+    size_t lowerBound(int value) const {
+        size_t position = 0;
+        for (unsigned i = 0; i < length; i++) {
+            position += values[i] < value;
+        }
+        return position;
+    }
+
+    // Returns the number of values not greater than value.
+    size_t upperBound(int value) const {
+        size_t position = 0;
+        for (unsigned i = 0; i < length; i++) {
+            position += values[i] <= value;
+        }
+        return position;
+    }
+
+    bool contains(int value) const {
+        size_t position = lowerBound(value);
+        return position < length && values[position] == value;
+    }
+
+    // Inserts value after its equals. The array must not be full.
+    void insert(int value) {
+        size_t position = upperBound(value);
+        for (size_t i = length; i > position; i--) {
+            values[i] = values[i - 1];
+        }
+        values[position] = value;
+        length++;
+    }
+
+    // Appends value, which must not be smaller than back(). The array must not be full.
+    void pushBack(int value) {
+        values[length++] = value;
+    }
+
+    // Removes the value at index.
+    void removeAt(size_t index) {
+        for (size_t i = index + 1; i < length; i++) {
+            values[i - 1] = values[i];
+        }
+        length--;
+    }
+
+    // Removes one copy of value, returns false if it is not stored.
+    bool removeOne(int value) {
+        size_t position = lowerBound(value);
+        if (position == length || values[position] != value) {
+            return false;
+        }
+        removeAt(position);
+        return true;
+    }
+};
+
+#endif // INLINE_SORTED_ARRAY_H
@@ -0,0 +1,97 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef LOSER_TREE_H
+#define LOSER_TREE_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Tournament tree of losers over the current keys of k sorted sources, for k-way merging.
+// The winner (smallest key, lowest source on ties) is known in O(1); replacing its key
+// replays only the matches on its path to the root, so each merged key costs log2(k)
+// comparisons against the stored losers and no sibling lookups.
+class LoserTree {
+private:
+    size_t k;
+    std::vector<int> keys;            // current key of every source
+    std::vector<char> exhausted;      // sources with no keys left lose every match
+    std::vector<size_t> nodes;        // nodes[0]: winner, nodes[1..k-1]: loser of that match
+
+    // Returns true if source a wins its match against source b
+    bool _beats(size_t a, size_t b) const {
+        if (exhausted[a] || exhausted[b]) {
+            return exhausted[a] == exhausted[b] ? a < b : exhausted[b] != 0;
+        }
+        return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+    }
+
+    // Helper to play every match below node (leaves are k..2k-1), returns the winner
+    size_t _build(size_t node) {
+        if (node >= k) {
+            return node - k;
+        }
+        size_t left = _build(2 * node);
+        size_t right = _build(2 * node + 1);
+        if (_beats(left, right)) {
+            nodes[node] = right;
+            return left;
+        }
+        nodes[node] = left;
+        return right;
+    }
+
+    // Helper to replay the matches on the path of source after its key changed
+    void _replay(size_t source) {
+        size_t winner = source;
+        for (size_t node = (source + k) / 2; node > 0; node /= 2) {
+            if (_beats(nodes[node], winner)) {
+                std::swap(nodes[node], winner);
+            }
+        }
+        nodes[0] = winner;
+    }
+
+public:
+    // Creates a tree over k sources, all exhausted until set() and build().
+    LoserTree(size_t k) : k(k), keys(k), exhausted(k, 1), nodes(k > 0 ? k : 1, 0) {}
+
+    // Sets the first key of source (before build()).
+    void set(size_t source, int key) {
+        keys[source] = key;
+        exhausted[source] = 0;
+    }
+
+    // Plays the whole tournament.
+    void build() {
+        nodes[0] = k > 0 ? _build(1) : 0;
+    }
+
+    // Returns true once every source is exhausted.
+    bool empty() const {
+        return k == 0 || exhausted[nodes[0]] != 0;
+    }
+
+    // Returns the source holding the smallest key and that key.
+    size_t winner() const {
+        return nodes[0];
+    }
+    int winnerKey() const {
+        return keys[nodes[0]];
+    }
+
+    // Gives the winner its next key / marks it exhausted, and finds the new winner.
+    void replaceWinner(int key) {
+        keys[nodes[0]] = key;
+        _replay(nodes[0]);
+    }
+    void exhaustWinner() {
+        exhausted[nodes[0]] = 1;
+        _replay(nodes[0]);
+    }
+};
+
+#endif // LOSER_TREE_H
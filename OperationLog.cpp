@@ -0,0 +1,513 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "OperationLog.h"
+#include "BinaryTree.h"
+#include "SortedList.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t kRecordSize = 5;
+static const char kInsertRecord = 'I';
+static const char kRemoveRecord = 'R';
+static const char kSnapshotMagic[4] = {'O', 'L', 'S', '1'};
+static const size_t kBufferLimit = 1 << 20;  // pending bytes that force an early write
+static const size_t kReadChunk = kRecordSize * (1 << 18);
+
+// Throws std::runtime_error describing the failed system call
+static void throwSystemError(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+static void putInt32(char* out, uint32_t value) {
+    out[0] = static_cast<char>(value);
+    out[1] = static_cast<char>(value >> 8);
+    out[2] = static_cast<char>(value >> 16);
+    out[3] = static_cast<char>(value >> 24);
+}
+
+static uint32_t getInt32(const char* in) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+static void putInt64(char* out, uint64_t value) {
+    putInt32(out, static_cast<uint32_t>(value));
+    putInt32(out + 4, static_cast<uint32_t>(value >> 32));
+}
+
+static uint64_t getInt64(const char* in) {
+    return getInt32(in) | (static_cast<uint64_t>(getInt32(in + 4)) << 32);
+}
+
+// Writes the whole buffer, retrying short writes
+static void writeAll(int fd, const char* data, size_t size, const std::string& path) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throwSystemError("Cannot write", path);
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+// Reads up to size bytes, returns fewer only at the end of the file
+static size_t readFully(int fd, char* data, size_t size, const std::string& path) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t got = ::read(fd, data + total, size - total);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throwSystemError("Cannot read", path);
+        }
+        if (got == 0) {
+            break;
+        }
+        total += static_cast<size_t>(got);
+    }
+    return total;
+}
+
+// Makes a rename or unlink inside the directory durable
+static void syncDirectory(const std::string& directory) {
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+static std::string segmentPath(const std::string& directory, uint64_t id) {
+    return directory + "/log." + std::to_string(id);
+}
+
+// Returns the ids of every log segment in the directory in ascending order
+static std::vector<uint64_t> listSegments(const std::string& directory) {
+    std::vector<uint64_t> ids;
+    DIR* dir = ::opendir(directory.c_str());
+    if (dir == nullptr) {
+        return ids;
+    }
+    while (struct dirent* entry = ::readdir(dir)) {
+        const char* name = entry->d_name;
+        if (std::strncmp(name, "log.", 4) != 0 || name[4] == '\0') {
+            continue;
+        }
+        char* end = nullptr;
+        unsigned long long id = std::strtoull(name + 4, &end, 10);
+        if (*end == '\0') {
+            ids.push_back(id);
+        }
+    }
+    ::closedir(dir);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Sorts values with four 8-bit LSD radix passes, which beats comparison sorting
+// on the hundreds of millions of values a long log replays.
+static void radixSort(std::vector<int>& values) {
+    if (values.size() < 1024) {
+        std::sort(values.begin(), values.end());
+        return;
+    }
+    std::vector<uint32_t> keys(values.size());
+    std::vector<uint32_t> scratch(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        keys[i] = static_cast<uint32_t>(values[i]) ^ 0x80000000u; // negative values first
+    }
+    for (unsigned shift = 0; shift < 32; shift += 8) {
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < keys.size(); i++) {
+            offsets[(keys[i] >> shift) & 0xFF]++;
+        }
+        if (offsets[(keys[0] >> shift) & 0xFF] == keys.size()) {
+            continue; // every key has the same byte here
+        }
+        size_t position = 0;
+        for (unsigned digit = 0; digit < 256; digit++) {
+            size_t bucket = offsets[digit];
+            offsets[digit] = position;
+            position += bucket;
+        }
+        for (size_t i = 0; i < keys.size(); i++) {
+            scratch[offsets[(keys[i] >> shift) & 0xFF]++] = keys[i];
+        }
+        keys.swap(scratch);
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<int>(keys[i] ^ 0x80000000u);
+    }
+}
+
+// --- Private Helper Functions ---
+
+// Helper to open the next log segment for appending
+void OperationLog::_openSegment(uint64_t id) {
+    std::string path = segmentPath(directory, id);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        throwSystemError("Cannot open log segment", path);
+    }
+    segment_fd = fd;
+    segment_id = id;
+    syncDirectory(directory);
+}
+
+// Helper to buffer one record and write it out as the durability level requires
+void OperationLog::_append(char op, int value) {
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if (!background_error.empty()) {
+            throw std::runtime_error(background_error);
+        }
+        size_t offset = pending.size();
+        pending.resize(offset + kRecordSize);
+        pending[offset] = op;
+        putInt32(&pending[offset + 1], static_cast<uint32_t>(value));
+        full = pending.size() >= kBufferLimit;
+    }
+    appended_records++;
+
+    if (durability == Durability::EveryOperation) {
+        std::lock_guard<std::mutex> io(io_mutex);
+        _writePending(true);
+    }
+    else if (full) {
+        if (durability == Durability::GroupCommit) {
+            wake_flusher.notify_one();
+        }
+        else {
+            std::lock_guard<std::mutex> io(io_mutex);
+            _writePending(false);
+        }
+    }
+}
+
+// Helper to write the pending records to the segment, then fsync if requested
+// The caller holds io_mutex; appends can continue into the emptied pending buffer meanwhile
+void OperationLog::_writePending(bool sync) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        writing.swap(pending);
+    }
+    if (writing.empty()) {
+        return;
+    }
+    std::string path = segmentPath(directory, segment_id);
+    writeAll(segment_fd, writing.data(), writing.size(), path);
+    writing.clear();
+    if (sync) {
+        if (::fsync(segment_fd) != 0) {
+            throwSystemError("Cannot sync", path);
+        }
+        commits++;
+    }
+}
+
+// Helper for the group commit thread
+// Every commit interval (or sooner, when the buffer fills) the whole pending batch is
+// written with one write and made durable with one fsync.
+void OperationLog::_flusherLoop() {
+    std::unique_lock<std::mutex> lock(pending_mutex);
+    while (!stopping) {
+        wake_flusher.wait_for(lock, std::chrono::milliseconds(commit_interval_ms));
+        if (pending.empty()) {
+            continue;
+        }
+        lock.unlock();
+        try {
+            std::lock_guard<std::mutex> io(io_mutex);
+            _writePending(true);
+        } catch (const std::exception& e) {
+            lock.lock();
+            background_error = e.what();
+            return;
+        }
+        lock.lock();
+    }
+}
+
+// Helper for the compaction thread: writes the snapshot, then deletes replayed segments
+// The snapshot is written to a temporary file and renamed, so a crash leaves either the
+// old or the new snapshot; older segments are removed only after the rename is durable.
+void OperationLog::_writeSnapshot(std::vector<int> values, uint64_t first_segment) {
+    try {
+        std::string temp_path = directory + "/snapshot.tmp";
+        std::string final_path = directory + "/snapshot.bin";
+        int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throwSystemError("Cannot create snapshot", temp_path);
+        }
+        std::vector<char> buffer(4 + 8 + 8);
+        std::memcpy(&buffer[0], kSnapshotMagic, 4);
+        putInt64(&buffer[4], first_segment);
+        putInt64(&buffer[12], values.size());
+        buffer.reserve(kBufferLimit);
+        for (size_t i = 0; i < values.size(); i++) {
+            if (buffer.size() + 4 > kBufferLimit) {
+                writeAll(fd, buffer.data(), buffer.size(), temp_path);
+                buffer.clear();
+            }
+            size_t offset = buffer.size();
+            buffer.resize(offset + 4);
+            putInt32(&buffer[offset], static_cast<uint32_t>(values[i]));
+        }
+        writeAll(fd, buffer.data(), buffer.size(), temp_path);
+        if (::fsync(fd) != 0) {
+            ::close(fd);
+            throwSystemError("Cannot sync", temp_path);
+        }
+        ::close(fd);
+        if (::rename(temp_path.c_str(), final_path.c_str()) != 0) {
+            throwSystemError("Cannot rename snapshot", temp_path);
+        }
+        syncDirectory(directory);
+
+        std::vector<uint64_t> ids = listSegments(directory);
+        for (size_t i = 0; i < ids.size() && ids[i] < first_segment; i++) {
+            ::unlink(segmentPath(directory, ids[i]).c_str());
+        }
+        compactions++;
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        background_error = e.what();
+    }
+}
+
+// --- Public Member Functions ---
+
+// Constructor, opens the directory and starts a fresh segment after the existing ones
+OperationLog::OperationLog(const std::string& directory, Durability durability, unsigned commit_interval_ms)
+    : directory(directory), durability(durability), commit_interval_ms(commit_interval_ms > 0 ? commit_interval_ms : 1),
+      segment_fd(-1), segment_id(0), stopping(false), appended_records(0), commits(0), compactions(0) {
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        throwSystemError("Cannot create log directory", directory);
+    }
+    std::vector<uint64_t> ids = listSegments(directory);
+    _openSegment(ids.empty() ? 1 : ids.back() + 1);
+    pending.reserve(kBufferLimit + kRecordSize);
+    writing.reserve(kBufferLimit + kRecordSize);
+    if (durability == Durability::GroupCommit) {
+        flusher = std::thread(&OperationLog::_flusherLoop, this);
+    }
+}
+
+// Destructor, makes everything appended durable before closing the segment
+OperationLog::~OperationLog() {
+    if (flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            stopping = true;
+        }
+        wake_flusher.notify_one();
+        flusher.join();
+    }
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+    try {
+        std::lock_guard<std::mutex> io(io_mutex);
+        _writePending(durability != Durability::None);
+    } catch (const std::exception& e) {
+        std::cerr << "OperationLog: " << e.what() << std::endl;
+    }
+    ::close(segment_fd);
+}
+
+void OperationLog::logInsert(int value) {
+    _append(kInsertRecord, value);
+}
+
+void OperationLog::logRemove(int value) {
+    _append(kRemoveRecord, value);
+}
+
+// Write and fsync every operation appended so far
+void OperationLog::flush() {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if (!background_error.empty()) {
+            throw std::runtime_error(background_error);
+        }
+    }
+    std::lock_guard<std::mutex> io(io_mutex);
+    _writePending(true);
+}
+
+// Cut the log at a new segment and write the snapshot in the background
+void OperationLog::compact(std::vector<int> sorted_values) {
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+    uint64_t first_segment;
+    {
+        // Everything logged so far belongs to the old segment, which the snapshot replaces
+        std::lock_guard<std::mutex> io(io_mutex);
+        _writePending(true);
+        ::close(segment_fd);
+        _openSegment(segment_id + 1);
+        first_segment = segment_id;
+    }
+    compactor = std::thread(&OperationLog::_writeSnapshot, this, std::move(sorted_values), first_segment);
+}
+
+void OperationLog::compact(const BinaryTree& tree) {
+    std::vector<int> values;
+    values.reserve(tree.size());
+    tree.appendInOrder(values);
+    compact(std::move(values));
+}
+
+void OperationLog::compact(const SortedList& list) {
+    std::vector<int> values;
+    values.reserve(list.size());
+    list.appendInOrder(values);
+    compact(std::move(values));
+}
+
+// Read the snapshot and replay every later segment
+// Inserts and removes are collected separately and sorted, then applied with two linear
+// merges; the order of the records does not matter because only successful operations are logged.
+std::vector<int> OperationLog::recover(const std::string& directory) {
+    std::vector<int> snapshot;
+    uint64_t first_segment = 0;
+    std::string snapshot_path = directory + "/snapshot.bin";
+    int fd = ::open(snapshot_path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        char header[20];
+        if (readFully(fd, header, sizeof(header), snapshot_path) != sizeof(header) ||
+            std::memcmp(header, kSnapshotMagic, 4) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Corrupt snapshot " + snapshot_path);
+        }
+        first_segment = getInt64(header + 4);
+        uint64_t values = getInt64(header + 12);
+        // A corrupt count must not size the vector: the values have to fit in the file
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            throwSystemError("Cannot stat snapshot", snapshot_path);
+        }
+        if (values > (static_cast<uint64_t>(info.st_size) - sizeof(header)) / 4) {
+            ::close(fd);
+            throw std::runtime_error("Corrupt snapshot " + snapshot_path);
+        }
+        snapshot.resize(values);
+        std::vector<char> raw(kReadChunk - kReadChunk % 4);
+        for (size_t done = 0; done < values;) {
+            size_t want = std::min<uint64_t>(raw.size() / 4, values - done);
+            if (readFully(fd, raw.data(), want * 4, snapshot_path) != want * 4) {
+                ::close(fd);
+                throw std::runtime_error("Truncated snapshot " + snapshot_path);
+            }
+            for (size_t i = 0; i < want; i++) {
+                snapshot[done + i] = static_cast<int>(getInt32(&raw[i * 4]));
+            }
+            done += want;
+        }
+        ::close(fd);
+    }
+
+    std::vector<int> inserted;
+    std::vector<int> removed;
+    std::vector<char> chunk(kReadChunk);
+    std::vector<uint64_t> ids = listSegments(directory);
+    for (size_t s = 0; s < ids.size(); s++) {
+        if (ids[s] < first_segment) {
+            continue;
+        }
+        std::string path = segmentPath(directory, ids[s]);
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throwSystemError("Cannot open log segment", path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0) {
+            inserted.reserve(inserted.size() + info.st_size / kRecordSize);
+        }
+        size_t got;
+        while ((got = readFully(fd, chunk.data(), chunk.size(), path)) > 0) {
+            // A partial record can only be the torn tail of the segment
+            size_t records = got / kRecordSize;
+            for (size_t r = 0; r < records; r++) {
+                const char* record = &chunk[r * kRecordSize];
+                int value = static_cast<int>(getInt32(record + 1));
+                if (record[0] == kInsertRecord) {
+                    inserted.push_back(value);
+                }
+                else if (record[0] == kRemoveRecord) {
+                    removed.push_back(value);
+                }
+                else {
+                    ::close(fd);
+                    throw std::runtime_error("Corrupt record in log segment " + path);
+                }
+            }
+            if (got < chunk.size()) {
+                break;
+            }
+        }
+        ::close(fd);
+    }
+
+    radixSort(inserted);
+    radixSort(removed);
+    std::vector<int> merged(snapshot.size() + inserted.size());
+    std::merge(snapshot.begin(), snapshot.end(), inserted.begin(), inserted.end(), merged.begin());
+    std::vector<int>().swap(snapshot);
+    std::vector<int>().swap(inserted);
+    // Drop one copy per removal, as remove does (every removed value was present)
+    size_t kept = 0;
+    size_t r = 0;
+    for (size_t i = 0; i < merged.size(); i++) {
+        while (r < removed.size() && removed[r] < merged[i]) {
+            r++;
+        }
+        if (r < removed.size() && removed[r] == merged[i]) {
+            r++;
+            continue;
+        }
+        merged[kept++] = merged[i];
+    }
+    merged.resize(kept);
+    return merged;
+}
+
+// Replace the tree with the recovered values, built balanced in one pass
+void OperationLog::recover(const std::string& directory, BinaryTree& tree) {
+    tree.assignSorted(recover(directory));
+}
+
+// Replace the list with the recovered values, linked in one pass
+void OperationLog::recover(const std::string& directory, SortedList& list) {
+    list.assignSorted(recover(directory));
+}
+
+// Print the record and commit counters
+void OperationLog::printStats(std::ostream& os) const {
+    static const char* kDurabilityNames[] = {"none", "group_commit", "every_operation"};
+    os << "OperationLog: durability=" << kDurabilityNames[static_cast<int>(durability)]
+       << " segment=" << segment_id << " records=" << appended_records.load()
+       << " fsyncs=" << commits.load() << " compactions=" << compactions.load() << "\n";
+}
@@ -0,0 +1,114 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef OPERATION_LOG_H
+#define OPERATION_LOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class BinaryTree;
+class SortedList;
+
+// When appended operations reach the disk.
+enum class Durability {
+    None,           // written when the buffer fills or on flush(), never fsynced
+    GroupCommit,    // a background thread writes and fsyncs the pending batch every commit interval
+    EveryOperation  // every operation is written and fsynced before the call returns
+};
+
+// Append-only binary log of insert/remove operations, stored in a directory:
+//   log.<id>      segments of 5-byte records (1 byte op, 4 byte little-endian value)
+//   snapshot.bin  sorted values plus the first segment that still has to be replayed
+// Only successful operations are logged, so replay never depends on the order of
+// operations: the recovered values are snapshot + inserted - removed (as multisets).
+// A record cut short by a crash at the end of a segment is ignored on recovery.
+class OperationLog {
+private:
+    std::string directory;
+    Durability durability;
+    unsigned commit_interval_ms;
+
+    int segment_fd;
+    uint64_t segment_id;
+
+    std::mutex pending_mutex;         // guards pending, stopping and background_error
+    std::vector<char> pending;        // records not written yet
+    std::condition_variable wake_flusher;
+    bool stopping;
+    std::string background_error;     // first failure of a background thread, rethrown to the caller
+    std::thread flusher;              // group commit thread
+
+    std::mutex io_mutex;              // serializes writes, fsyncs and segment switches
+    std::vector<char> writing;        // batch being written, swapped with pending
+    std::thread compactor;            // writes the latest snapshot in the background
+
+    std::atomic<uint64_t> appended_records;
+    std::atomic<uint64_t> commits;
+    std::atomic<uint64_t> compactions;
+
+    // Helper to open the next log segment for appending
+    void _openSegment(uint64_t id);
+
+    // Helper to buffer one record and write it out as the durability level requires
+    void _append(char op, int value);
+
+    // Helper to write the pending records to the segment, then fsync if requested (caller holds io_mutex)
+    void _writePending(bool sync);
+
+    // Helper for the group commit thread
+    void _flusherLoop();
+
+    // Helper for the compaction thread: writes the snapshot, then deletes replayed segments
+    void _writeSnapshot(std::vector<int> values, uint64_t first_segment);
+
+    // Copying a log would duplicate its file descriptor and threads
+    OperationLog(const OperationLog&);
+    OperationLog& operator=(const OperationLog&);
+
+public:
+    // Opens (creating if needed) the log directory and starts a new segment after any
+    // existing ones, so a segment torn by a crash is never appended to.
+    explicit OperationLog(const std::string& directory, Durability durability = Durability::GroupCommit,
+                          unsigned commit_interval_ms = 5);
+
+    // Writes and fsyncs everything pending and waits for a running compaction.
+    ~OperationLog();
+
+    // Appends one operation.
+    void logInsert(int value);
+    void logRemove(int value);
+
+    // Writes and fsyncs every operation appended so far.
+    void flush();
+
+    // Starts a new segment and writes sorted_values as the snapshot on a background thread.
+    // sorted_values must be the container contents after the last logged operation;
+    // older segments are deleted once the snapshot is safely on disk.
+    void compact(std::vector<int> sorted_values);
+    void compact(const BinaryTree& tree);
+    void compact(const SortedList& list);
+
+    // Reads the snapshot and replays every later segment.
+    // Returns the recovered values in ascending order.
+    static std::vector<int> recover(const std::string& directory);
+
+    // Replaces the contents of the container with the recovered values (bulk build, no per
+    // value insert, see assignSorted). The settings of the container are kept and a membership
+    // filter is rebuilt. Call this before attaching the log, or the values are snapshotted again.
+    static void recover(const std::string& directory, BinaryTree& tree);
+    static void recover(const std::string& directory, SortedList& list);
+
+    // Prints the record and commit counters.
+    void printStats(std::ostream& os = std::cout) const;
+};
+
+#endif // OPERATION_LOG_H
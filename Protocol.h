@@ -0,0 +1,102 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+// Binary protocol of the server mode (Server.h) and of the load generator.
+//
+// A request is a 2-byte header followed by its arguments, all integers 32-bit
+// little-endian:
+//   [opcode][target] [value]        Insert, Search, Remove
+//   [opcode][target]                Min, Max
+//   [opcode][target] [low][high]    Range (inclusive bounds)
+// target selects the container (TargetContainer::Tree or TargetContainer::List).
+//
+// Every request gets exactly one response, in request order, so a client may
+// send many requests before reading (pipelining):
+//   [status]                        Insert, Search, Remove, and every error
+//   [status][value]                 Min, Max with ResponseStatus::Ok
+//   [status][count][count values]   Range with ResponseStatus::Ok or ResponseStatus::Truncated
+// A request with an unknown opcode or target is answered with ResponseStatus::BadRequest
+// and the connection is closed after the responses before it are sent.
+
+#include <cstddef>
+#include <cstdint>
+
+enum class Opcode : uint8_t {
+    Insert = 1,
+    Search = 2,
+    Remove = 3,
+    Min = 4,
+    Max = 5,
+    Range = 6
+};
+
+enum class TargetContainer : uint8_t {
+    Tree = 0,
+    List = 1
+};
+
+enum class ResponseStatus : uint8_t {
+    Ok = 0,          // done; for Search and Remove: the value was found
+    NotFound = 1,    // Search or Remove of a missing value
+    Empty = 2,       // Min or Max of an empty container
+    Truncated = 3,   // Range matched more than kMaxRangeValues, only the first ones are sent
+    BadRequest = 4   // unknown opcode or target
+};
+
+// Largest number of values a single Range response carries
+static const uint32_t kMaxRangeValues = 1 << 16;
+
+inline void encodeInt32(char* out, uint32_t value) {
+    out[0] = static_cast<char>(value);
+    out[1] = static_cast<char>(value >> 8);
+    out[2] = static_cast<char>(value >> 16);
+    out[3] = static_cast<char>(value >> 24);
+}
+
+inline uint32_t decodeInt32(const char* in) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+// Returns the size of a request with this opcode, or 0 if the opcode is unknown.
+inline size_t requestLength(uint8_t opcode) {
+    switch (static_cast<Opcode>(opcode)) {
+        case Opcode::Insert:
+        case Opcode::Search:
+        case Opcode::Remove:
+            return 2 + 4;
+        case Opcode::Min:
+        case Opcode::Max:
+            return 2;
+        case Opcode::Range:
+            return 2 + 8;
+    }
+    return 0;
+}
+
+// Returns the size of the response to a request with this opcode that starts at data,
+// or 0 if fewer than available bytes hold it completely.
+inline size_t responseLength(Opcode opcode, const char* data, size_t available) {
+    if (available < 1) {
+        return 0;
+    }
+    ResponseStatus status = static_cast<ResponseStatus>(data[0]);
+    size_t length = 1;
+    if ((opcode == Opcode::Min || opcode == Opcode::Max) && status == ResponseStatus::Ok) {
+        length += 4;
+    }
+    else if (opcode == Opcode::Range && (status == ResponseStatus::Ok || status == ResponseStatus::Truncated)) {
+        if (available < 5) {
+            return 0;
+        }
+        length += 4 + 4 * static_cast<size_t>(decodeInt32(data + 1));
+    }
+    return available >= length ? length : 0;
+}
+
+#endif // PROTOCOL_H
@@ -0,0 +1,793 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "RadixTree.h"
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// A Node256 shrinks to a Node48 / a Node48 to a Node16 at this many children. Both are below
+// the capacity of the smaller type, so a node whose size hovers at a boundary does not thrash.
+static const uint16_t kShrinkNode256 = 37;
+static const uint16_t kShrinkNode48 = 12;
+
+// --- Node Constructors ---
+
+RadixTree::Node::Node(NodeType type) : type(type), prefix_length(0), children(0) {}
+
+RadixTree::Leaf::Leaf(uint32_t key) : Node(NodeType::Leaf), key(key), copies(1) {}
+
+RadixTree::Node4::Node4() : Node(NodeType::Node4) {
+    memset(keys, 0, sizeof(keys));
+    memset(child, 0, sizeof(child));
+}
+
+RadixTree::Node16::Node16() : Node(NodeType::Node16) {
+    memset(keys, 0, sizeof(keys));
+    memset(child, 0, sizeof(child));
+}
+
+RadixTree::Node48::Node48() : Node(NodeType::Node48) {
+    memset(index, 0, sizeof(index));
+    memset(child, 0, sizeof(child));
+}
+
+RadixTree::Node256::Node256() : Node(NodeType::Node256) {
+    memset(child, 0, sizeof(child));
+}
+
+// --- Private Helper Functions ---
+
+// Helpers to map values to keys and back
+// Flipping the sign bit makes the unsigned order of the keys the signed order of the values
+uint32_t RadixTree::_toKey(int value) {
+    return static_cast<uint32_t>(value) ^ 0x80000000u;
+}
+
+int RadixTree::_toValue(uint32_t key) {
+    return static_cast<int>(key ^ 0x80000000u);
+}
+
+uint8_t RadixTree::_byte(uint32_t key, size_t depth) {
+    return static_cast<uint8_t>(key >> (24 - 8 * depth));
+}
+
+// Helper function to match the compressed path of node
+size_t RadixTree::_matchPrefix(const Node* node, uint32_t key, size_t depth) {
+    size_t matched = 0;
+    while (matched < node->prefix_length && node->prefix[matched] == _byte(key, depth + matched)) {
+        matched++;
+    }
+    return matched;
+}
+
+// Helper function to find a child
+// A Node16 compares all its keys at once when SSE2 is available
+RadixTree::Node** RadixTree::_findChild(Node* node, uint8_t byte) {
+    switch (node->type) {
+        case NodeType::Node4: {
+            Node4* node4 = static_cast<Node4*>(node);
+            for (uint16_t i = 0; i < node4->children; i++) {
+                if (node4->keys[i] == byte) {
+                    return &node4->child[i];
+                }
+            }
+            return nullptr;
+        }
+        case NodeType::Node16: {
+            Node16* node16 = static_cast<Node16*>(node);
+#ifdef __SSE2__
+            __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(node16->keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(matches)) & ((1u << node16->children) - 1);
+            return mask != 0 ? &node16->child[__builtin_ctz(mask)] : nullptr;
+#else
+            for (uint16_t i = 0; i < node16->children; i++) {
+                if (node16->keys[i] == byte) {
+                    return &node16->child[i];
+                }
+            }
+            return nullptr;
+#endif
+        }
+        case NodeType::Node48: {
+            Node48* node48 = static_cast<Node48*>(node);
+            return node48->index[byte] != 0 ? &node48->child[node48->index[byte] - 1] : nullptr;
+        }
+        case NodeType::Node256: {
+            Node256* node256 = static_cast<Node256*>(node);
+            return node256->child[byte] != nullptr ? &node256->child[byte] : nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+// Helper function to copy a node header when a node changes type
+void RadixTree::_copyHeader(Node* to, const Node* from) {
+    to->prefix_length = from->prefix_length;
+    to->children = from->children;
+    memcpy(to->prefix, from->prefix, sizeof(from->prefix));
+}
+
+// Helper function to add a child, growing the node when it is full
+void RadixTree::_addChild(Node** link, uint8_t byte, Node* child) {
+    Node* node = *link;
+    switch (node->type) {
+        case NodeType::Node4: {
+            Node4* node4 = static_cast<Node4*>(node);
+            if (node4->children < 4) {
+                uint16_t position = 0;
+                while (position < node4->children && node4->keys[position] < byte) {
+                    position++;
+                }
+                memmove(node4->keys + position + 1, node4->keys + position, node4->children - position);
+                memmove(node4->child + position + 1, node4->child + position, (node4->children - position) * sizeof(Node*));
+                node4->keys[position] = byte;
+                node4->child[position] = child;
+                node4->children++;
+                return;
+            }
+            Node16* grown = new Node16();
+            _copyHeader(grown, node4);
+            memcpy(grown->keys, node4->keys, sizeof(node4->keys));
+            memcpy(grown->child, node4->child, sizeof(node4->child));
+            delete node4;
+            *link = grown;
+            break;
+        }
+        case NodeType::Node16: {
+            Node16* node16 = static_cast<Node16*>(node);
+            if (node16->children < 16) {
+                uint16_t position = 0;
+                while (position < node16->children && node16->keys[position] < byte) {
+                    position++;
+                }
+                memmove(node16->keys + position + 1, node16->keys + position, node16->children - position);
+                memmove(node16->child + position + 1, node16->child + position,
+                        (node16->children - position) * sizeof(Node*));
+                node16->keys[position] = byte;
+                node16->child[position] = child;
+                node16->children++;
+                return;
+            }
+            Node48* grown = new Node48();
+            _copyHeader(grown, node16);
+            for (uint8_t i = 0; i < 16; i++) {
+                grown->index[node16->keys[i]] = i + 1;
+                grown->child[i] = node16->child[i];
+            }
+            delete node16;
+            *link = grown;
+            break;
+        }
+        case NodeType::Node48: {
+            Node48* node48 = static_cast<Node48*>(node);
+            if (node48->children < 48) {
+                // Removal leaves holes, so look for a free slot
+                uint8_t slot = 0;
+                while (node48->child[slot] != nullptr) {
+                    slot++;
+                }
+                node48->index[byte] = slot + 1;
+                node48->child[slot] = child;
+                node48->children++;
+                return;
+            }
+            Node256* grown = new Node256();
+            _copyHeader(grown, node48);
+            for (size_t i = 0; i < 256; i++) {
+                if (node48->index[i] != 0) {
+                    grown->child[i] = node48->child[node48->index[i] - 1];
+                }
+            }
+            delete node48;
+            *link = grown;
+            break;
+        }
+        case NodeType::Node256: {
+            Node256* node256 = static_cast<Node256*>(node);
+            node256->child[byte] = child;
+            node256->children++;
+            return;
+        }
+        default:
+            throw std::logic_error("RadixTree: cannot add a child to a leaf.");
+    }
+    // The node was full and has been replaced by the next bigger type
+    _addChild(link, byte, child);
+}
+
+// Helper function to remove a child, shrinking the node when it gets sparse
+void RadixTree::_removeChild(Node** link, uint8_t byte) {
+    Node* node = *link;
+    switch (node->type) {
+        case NodeType::Node4: {
+            Node4* node4 = static_cast<Node4*>(node);
+            uint16_t position = 0;
+            while (node4->keys[position] != byte) {
+                position++;
+            }
+            node4->children--;
+            memmove(node4->keys + position, node4->keys + position + 1, node4->children - position);
+            memmove(node4->child + position, node4->child + position + 1, (node4->children - position) * sizeof(Node*));
+            // The slot freed by the shift still holds the last child, which may be the one just deleted
+            node4->keys[node4->children] = 0;
+            node4->child[node4->children] = nullptr;
+            if (node4->children > 1) {
+                return;
+            }
+            // One child left: it takes the place of the node, and an inner child takes over the
+            // compressed path of the node and the byte that led to it
+            Node* only = node4->child[0];
+            if (only->type != NodeType::Leaf) {
+                uint8_t prefix[3];
+                size_t length = 0;
+                for (size_t i = 0; i < node4->prefix_length; i++) {
+                    prefix[length++] = node4->prefix[i];
+                }
+                prefix[length++] = node4->keys[0];
+                for (size_t i = 0; i < only->prefix_length; i++) {
+                    prefix[length++] = only->prefix[i];
+                }
+                memcpy(only->prefix, prefix, length);
+                only->prefix_length = static_cast<uint8_t>(length);
+            }
+            delete node4;
+            *link = only;
+            return;
+        }
+        case NodeType::Node16: {
+            Node16* node16 = static_cast<Node16*>(node);
+            uint16_t position = 0;
+            while (node16->keys[position] != byte) {
+                position++;
+            }
+            node16->children--;
+            memmove(node16->keys + position, node16->keys + position + 1, node16->children - position);
+            memmove(node16->child + position, node16->child + position + 1,
+                    (node16->children - position) * sizeof(Node*));
+            node16->keys[node16->children] = 0;
+            node16->child[node16->children] = nullptr;
+            if (node16->children > 3) {
+                return;
+            }
+            Node4* shrunk = new Node4();
+            _copyHeader(shrunk, node16);
+            memcpy(shrunk->keys, node16->keys, node16->children);
+            memcpy(shrunk->child, node16->child, node16->children * sizeof(Node*));
+            delete node16;
+            *link = shrunk;
+            return;
+        }
+        case NodeType::Node48: {
+            Node48* node48 = static_cast<Node48*>(node);
+            node48->child[node48->index[byte] - 1] = nullptr;
+            node48->index[byte] = 0;
+            node48->children--;
+            if (node48->children > kShrinkNode48) {
+                return;
+            }
+            Node16* shrunk = new Node16();
+            _copyHeader(shrunk, node48);
+            uint16_t next = 0;
+            for (size_t i = 0; i < 256; i++) {
+                if (node48->index[i] != 0) {
+                    shrunk->keys[next] = static_cast<uint8_t>(i);
+                    shrunk->child[next] = node48->child[node48->index[i] - 1];
+                    next++;
+                }
+            }
+            delete node48;
+            *link = shrunk;
+            return;
+        }
+        case NodeType::Node256: {
+            Node256* node256 = static_cast<Node256*>(node);
+            node256->child[byte] = nullptr;
+            node256->children--;
+            if (node256->children > kShrinkNode256) {
+                return;
+            }
+            Node48* shrunk = new Node48();
+            _copyHeader(shrunk, node256);
+            uint8_t next = 0;
+            for (size_t i = 0; i < 256; i++) {
+                if (node256->child[i] != nullptr) {
+                    shrunk->index[i] = next + 1;
+                    shrunk->child[next] = node256->child[i];
+                    next++;
+                }
+            }
+            delete node256;
+            *link = shrunk;
+            return;
+        }
+        default:
+            throw std::logic_error("RadixTree: cannot remove a child from a leaf.");
+    }
+}
+
+// Helper for recursive remove
+// Looks one level ahead so the parent of a removed leaf can drop it
+bool RadixTree::_remove(Node** link, uint32_t key, size_t depth) {
+    Node* node = *link;
+    if (_matchPrefix(node, key, depth) < node->prefix_length) {
+        return false;
+    }
+    depth += node->prefix_length;
+    uint8_t byte = _byte(key, depth);
+    Node** child = _findChild(node, byte);
+    if (child == nullptr) {
+        return false;
+    }
+    if ((*child)->type != NodeType::Leaf) {
+        return _remove(child, key, depth + 1);
+    }
+    Leaf* leaf = static_cast<Leaf*>(*child);
+    if (leaf->key != key) {
+        return false;
+    }
+    if (--leaf->copies == 0) {
+        delete leaf;
+        _removeChild(link, byte);
+    }
+    return true;
+}
+
+// Helper for getMinValue
+// Follows the smallest byte at every level
+const RadixTree::Leaf* RadixTree::_minLeaf(const Node* node) {
+    for (;;) {
+        switch (node->type) {
+            case NodeType::Leaf:
+                return static_cast<const Leaf*>(node);
+            case NodeType::Node4:
+                node = static_cast<const Node4*>(node)->child[0];
+                break;
+            case NodeType::Node16:
+                node = static_cast<const Node16*>(node)->child[0];
+                break;
+            case NodeType::Node48: {
+                const Node48* node48 = static_cast<const Node48*>(node);
+                size_t i = 0;
+                while (node48->index[i] == 0) {
+                    i++;
+                }
+                node = node48->child[node48->index[i] - 1];
+                break;
+            }
+            case NodeType::Node256: {
+                const Node256* node256 = static_cast<const Node256*>(node);
+                size_t i = 0;
+                while (node256->child[i] == nullptr) {
+                    i++;
+                }
+                node = node256->child[i];
+                break;
+            }
+        }
+    }
+}
+
+// Helper for getMaxValue
+// Follows the largest byte at every level
+const RadixTree::Leaf* RadixTree::_maxLeaf(const Node* node) {
+    for (;;) {
+        switch (node->type) {
+            case NodeType::Leaf:
+                return static_cast<const Leaf*>(node);
+            case NodeType::Node4:
+                node = static_cast<const Node4*>(node)->child[node->children - 1];
+                break;
+            case NodeType::Node16:
+                node = static_cast<const Node16*>(node)->child[node->children - 1];
+                break;
+            case NodeType::Node48: {
+                const Node48* node48 = static_cast<const Node48*>(node);
+                size_t i = 255;
+                while (node48->index[i] == 0) {
+                    i--;
+                }
+                node = node48->child[node48->index[i] - 1];
+                break;
+            }
+            case NodeType::Node256: {
+                const Node256* node256 = static_cast<const Node256*>(node);
+                size_t i = 255;
+                while (node256->child[i] == nullptr) {
+                    i--;
+                }
+                node = node256->child[i];
+                break;
+            }
+        }
+    }
+}
+
+// Helper for the in-order traversals
+// Children are visited in byte order, which is key order
+template <typename Visit>
+void RadixTree::_forEachLeaf(const Node* node, Visit& visit) {
+    if (node == nullptr) {
+        return;
+    }
+    switch (node->type) {
+        case NodeType::Leaf:
+            visit(static_cast<const Leaf*>(node));
+            return;
+        case NodeType::Node4:
+            for (uint16_t i = 0; i < node->children; i++) {
+                _forEachLeaf(static_cast<const Node4*>(node)->child[i], visit);
+            }
+            return;
+        case NodeType::Node16:
+            for (uint16_t i = 0; i < node->children; i++) {
+                _forEachLeaf(static_cast<const Node16*>(node)->child[i], visit);
+            }
+            return;
+        case NodeType::Node48: {
+            const Node48* node48 = static_cast<const Node48*>(node);
+            for (size_t i = 0; i < 256; i++) {
+                if (node48->index[i] != 0) {
+                    _forEachLeaf(node48->child[node48->index[i] - 1], visit);
+                }
+            }
+            return;
+        }
+        case NodeType::Node256:
+            for (size_t i = 0; i < 256; i++) {
+                _forEachLeaf(static_cast<const Node256*>(node)->child[i], visit);
+            }
+            return;
+    }
+}
+
+// Helper for deep copying a subtree
+RadixTree::Node* RadixTree::_copy(const Node* node) {
+    if (node == nullptr) {
+        return nullptr;
+    }
+    switch (node->type) {
+        case NodeType::Leaf:
+            return new Leaf(*static_cast<const Leaf*>(node));
+        case NodeType::Node4: {
+            Node4* copy = new Node4(*static_cast<const Node4*>(node));
+            for (uint16_t i = 0; i < copy->children; i++) {
+                copy->child[i] = _copy(copy->child[i]);
+            }
+            return copy;
+        }
+        case NodeType::Node16: {
+            Node16* copy = new Node16(*static_cast<const Node16*>(node));
+            for (uint16_t i = 0; i < copy->children; i++) {
+                copy->child[i] = _copy(copy->child[i]);
+            }
+            return copy;
+        }
+        case NodeType::Node48: {
+            Node48* copy = new Node48(*static_cast<const Node48*>(node));
+            for (size_t i = 0; i < 48; i++) {
+                copy->child[i] = _copy(copy->child[i]);
+            }
+            return copy;
+        }
+        case NodeType::Node256: {
+            Node256* copy = new Node256(*static_cast<const Node256*>(node));
+            for (size_t i = 0; i < 256; i++) {
+                copy->child[i] = _copy(copy->child[i]);
+            }
+            return copy;
+        }
+    }
+    return nullptr;
+}
+
+// Helper for destructor and assignment
+// Frees every node of a subtree
+void RadixTree::_destroy(Node* node) {
+    if (node == nullptr) {
+        return;
+    }
+    switch (node->type) {
+        case NodeType::Leaf:
+            delete static_cast<Leaf*>(node);
+            return;
+        case NodeType::Node4: {
+            Node4* node4 = static_cast<Node4*>(node);
+            for (uint16_t i = 0; i < node4->children; i++) {
+                _destroy(node4->child[i]);
+            }
+            delete node4;
+            return;
+        }
+        case NodeType::Node16: {
+            Node16* node16 = static_cast<Node16*>(node);
+            for (uint16_t i = 0; i < node16->children; i++) {
+                _destroy(node16->child[i]);
+            }
+            delete node16;
+            return;
+        }
+        case NodeType::Node48: {
+            Node48* node48 = static_cast<Node48*>(node);
+            for (size_t i = 0; i < 48; i++) {
+                _destroy(node48->child[i]);
+            }
+            delete node48;
+            return;
+        }
+        case NodeType::Node256: {
+            Node256* node256 = static_cast<Node256*>(node);
+            for (size_t i = 0; i < 256; i++) {
+                _destroy(node256->child[i]);
+            }
+            delete node256;
+            return;
+        }
+    }
+}
+
+// --- Public Member Functions ---
+
+// Constructor
+RadixTree::RadixTree() : root(nullptr), count(0) {}
+
+// Destructor
+RadixTree::~RadixTree() {
+    _destroy(root);
+}
+
+// Copy Constructor
+RadixTree::RadixTree(const RadixTree& other) : root(_copy(other.root)), count(other.count) {}
+
+// Copy Assignment Operator
+RadixTree& RadixTree::operator=(const RadixTree& other) {
+    if (this == &other) {
+        return *this;
+    }
+    Node* copy = _copy(other.root);
+    _destroy(root);
+    root = copy;
+    count = other.count;
+    return *this;
+}
+
+// Move Constructor
+RadixTree::RadixTree(RadixTree&& other) noexcept : root(other.root), count(other.count) {
+    other.root = nullptr;
+    other.count = 0;
+}
+
+// Move Assignment Operator
+RadixTree& RadixTree::operator=(RadixTree&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    _destroy(root);
+    root = other.root;
+    count = other.count;
+    other.root = nullptr;
+    other.count = 0;
+    return *this;
+}
+
+// Check if the tree is empty
+bool RadixTree::isEmpty() const {
+    return count == 0;
+}
+
+// Get the number of values
+size_t RadixTree::size() const {
+    return count;
+}
+
+// Insert a new value
+// Walks down the key bytes; where the key leaves the existing paths, a Node4 is put in to
+// hold both the old subtree and the new leaf
+void RadixTree::insert(int value) {
+    uint32_t key = _toKey(value);
+    Node** link = &root;
+    size_t depth = 0;
+    for (;;) {
+        Node* node = *link;
+        if (node == nullptr) {
+            *link = new Leaf(key);
+            break;
+        }
+        if (node->type == NodeType::Leaf) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            if (leaf->key == key) {
+                leaf->copies++;
+                break;
+            }
+            // Two different keys: branch at the first byte where they differ
+            Node* split = new Node4();
+            size_t differ = depth;
+            while (_byte(leaf->key, differ) == _byte(key, differ)) {
+                split->prefix[differ - depth] = _byte(key, differ);
+                differ++;
+            }
+            split->prefix_length = static_cast<uint8_t>(differ - depth);
+            _addChild(&split, _byte(leaf->key, differ), leaf);
+            _addChild(&split, _byte(key, differ), new Leaf(key));
+            *link = split;
+            break;
+        }
+        size_t matched = _matchPrefix(node, key, depth);
+        if (matched < node->prefix_length) {
+            // The key leaves the compressed path: branch where it does, and the node keeps
+            // the part of its path below the branch
+            Node* split = new Node4();
+            split->prefix_length = static_cast<uint8_t>(matched);
+            memcpy(split->prefix, node->prefix, matched);
+            uint8_t node_byte = node->prefix[matched];
+            node->prefix_length = static_cast<uint8_t>(node->prefix_length - matched - 1);
+            memmove(node->prefix, node->prefix + matched + 1, node->prefix_length);
+            _addChild(&split, node_byte, node);
+            _addChild(&split, _byte(key, depth + matched), new Leaf(key));
+            *link = split;
+            break;
+        }
+        depth += node->prefix_length;
+        Node** child = _findChild(node, _byte(key, depth));
+        if (child == nullptr) {
+            _addChild(link, _byte(key, depth), new Leaf(key));
+            break;
+        }
+        link = child;
+        depth++;
+    }
+    count++;
+}
+
+// Search for a value
+// At most four inner nodes are visited, each costing one byte lookup
+bool RadixTree::search(int value) const {
+    uint32_t key = _toKey(value);
+    Node* node = root;
+    size_t depth = 0;
+    while (node != nullptr) {
+        if (node->type == NodeType::Leaf) {
+            return static_cast<const Leaf*>(node)->key == key;
+        }
+        if (_matchPrefix(node, key, depth) < node->prefix_length) {
+            return false;
+        }
+        depth += node->prefix_length;
+        Node** child = _findChild(node, _byte(key, depth));
+        if (child == nullptr) {
+            return false;
+        }
+        node = *child;
+        depth++;
+    }
+    return false;
+}
+
+// Print values in order
+void RadixTree::printInOrder() const {
+    if (isEmpty()) {
+        std::cout << "Tree is empty.\n";
+        return;
+    }
+    std::cout << *this << std::endl;
+}
+
+// Append the values in ascending order
+void RadixTree::appendInOrder(std::vector<int>& out) const {
+    struct Append {
+        std::vector<int>& out;
+        void operator()(const Leaf* leaf) {
+            out.insert(out.end(), leaf->copies, _toValue(leaf->key));
+        }
+    } append = {out};
+    _forEachLeaf(root, append);
+}
+
+// Get the minimum value in the tree
+int RadixTree::getMinValue() const {
+    if (isEmpty()) {
+        throw std::runtime_error("Attempted to get min value from an empty tree.");
+    }
+    return _toValue(_minLeaf(root)->key);
+}
+
+// Get the maximum value in the tree
+int RadixTree::getMaxValue() const {
+    if (isEmpty()) {
+        throw std::runtime_error("Attempted to get max value from an empty tree.");
+    }
+    return _toValue(_maxLeaf(root)->key);
+}
+
+// Remove a value from the tree
+void RadixTree::remove(int value) {
+    if (isEmpty()) {
+        throw std::runtime_error("Attempted to remove value from an empty tree.");
+    }
+    uint32_t key = _toKey(value);
+    bool removed = false;
+    if (root->type == NodeType::Leaf) {
+        Leaf* leaf = static_cast<Leaf*>(root);
+        if (leaf->key == key) {
+            removed = true;
+            if (--leaf->copies == 0) {
+                delete leaf;
+                root = nullptr;
+            }
+        }
+    }
+    else {
+        removed = _remove(&root, key, 0);
+    }
+    if (!removed) {
+        throw std::runtime_error("Value not found in tree for removal.");
+    }
+    count--;
+}
+
+// Print the statistics
+void RadixTree::printStats(std::ostream& os) const {
+    size_t nodes[5] = {0, 0, 0, 0, 0};
+    std::vector<const Node*> pending;
+    if (root != nullptr) {
+        pending.push_back(root);
+    }
+    while (!pending.empty()) {
+        const Node* node = pending.back();
+        pending.pop_back();
+        nodes[static_cast<size_t>(node->type)]++;
+        if (node->type == NodeType::Leaf) {
+            continue;
+        }
+        Node* const* first = nullptr;
+        size_t slots = 0;
+        switch (node->type) {
+            case NodeType::Node4: first = static_cast<const Node4*>(node)->child; slots = node->children; break;
+            case NodeType::Node16: first = static_cast<const Node16*>(node)->child; slots = node->children; break;
+            case NodeType::Node48: first = static_cast<const Node48*>(node)->child; slots = 48; break;
+            default: first = static_cast<const Node256*>(node)->child; slots = 256; break;
+        }
+        for (size_t i = 0; i < slots; i++) {
+            if (first[i] != nullptr) {
+                pending.push_back(first[i]);
+            }
+        }
+    }
+    size_t bytes = nodes[0] * sizeof(Leaf) + nodes[1] * sizeof(Node4) + nodes[2] * sizeof(Node16) +
+                   nodes[3] * sizeof(Node48) + nodes[4] * sizeof(Node256);
+    os << "RadixTree: size=" << count << " leaves=" << nodes[0] << " node4=" << nodes[1] << " node16=" << nodes[2]
+       << " node48=" << nodes[3] << " node256=" << nodes[4] << " node_bytes=" << bytes << "\n";
+}
+
+// --- Operators ---
+
+// Adds a value to the tree (uses the insert function)
+RadixTree& RadixTree::operator+=(int value) {
+    insert(value);
+    return *this;
+}
+
+// Prints the tree values in ascending order
+std::ostream& operator<<(std::ostream& os, const RadixTree& tree) {
+    if (tree.isEmpty()) {
+        os << "Tree is empty.";
+        return os;
+    }
+    struct Print {
+        std::ostream& os;
+        void operator()(const RadixTree::Leaf* leaf) {
+            for (uint32_t i = 0; i < leaf->copies; i++) {
+                os << RadixTree::_toValue(leaf->key) << " ";
+            }
+        }
+    } print = {os};
+    RadixTree::_forEachLeaf(tree.root, print);
+    return os;
+}
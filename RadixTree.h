@@ -0,0 +1,169 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef RADIX_TREE_H
+#define RADIX_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+class RadixTree;
+
+// Forward declaration of operator<< for friend declaration
+std::ostream& operator<<(std::ostream& os, const RadixTree& tree);
+
+// Adaptive radix tree (Leis et al., "The Adaptive Radix Tree") over the four bytes of an int
+// key, most significant byte first, with the sign bit flipped so byte order is value order.
+//
+// Every inner node branches on one key byte and comes in four sizes - 4, 16, 48 and 256
+// children - that grow and shrink with the number of children, so sparse levels stay small
+// and dense ones are a direct array lookup. A subtree holding a single key is just its leaf
+// (lazy expansion), and the key bytes that every key below a node shares are kept in the
+// node instead of a chain of one-child nodes (path compression). A lookup therefore visits
+// at most four inner nodes however many keys the tree holds, and never compares whole keys
+// until the leaf. Same value semantics as BinaryTree: duplicates are kept (a leaf counts them).
+class RadixTree {
+private:
+    enum class NodeType : uint8_t { Leaf, Node4, Node16, Node48, Node256 };
+
+    // Header shared by every node. prefix holds the bytes all keys below an inner node share
+    // after the byte its parent branched on; at most 3, since the node itself branches on one
+    // of the 4 key bytes.
+    struct Node {
+        NodeType type;
+        uint8_t prefix_length;
+        uint16_t children;
+        uint8_t prefix[3];
+
+        Node(NodeType type);
+    };
+
+    struct Leaf : Node {
+        uint32_t key;     // the value with its sign bit flipped
+        uint32_t copies;
+
+        Leaf(uint32_t key);
+    };
+
+    // Up to 4 / 16 children, keys sorted
+    struct Node4 : Node {
+        uint8_t keys[4];
+        Node* child[4];
+
+        Node4();
+    };
+    struct Node16 : Node {
+        uint8_t keys[16];
+        Node* child[16];
+
+        Node16();
+    };
+
+    // Up to 48 children, index[byte] is the slot of the child plus one (0: none)
+    struct Node48 : Node {
+        uint8_t index[256];
+        Node* child[48];
+
+        Node48();
+    };
+
+    struct Node256 : Node {
+        Node* child[256];
+
+        Node256();
+    };
+
+    Node* root;
+    size_t count;
+
+    // Helpers to map values to keys and back, and to take the key byte at depth (0: most significant)
+    static uint32_t _toKey(int value);
+    static int _toValue(uint32_t key);
+    static uint8_t _byte(uint32_t key, size_t depth);
+
+    // Helper function to count how many prefix bytes of node match key from depth
+    static size_t _matchPrefix(const Node* node, uint32_t key, size_t depth);
+
+    // Helper function to find the link to the child of node for byte, nullptr if there is none
+    static Node** _findChild(Node* node, uint8_t byte);
+
+    // Helper functions to add / remove the child for byte of *node, replacing *node with a
+    // bigger or smaller node type when needed. Removing the last but one child of a Node4
+    // replaces it with its remaining child.
+    static void _addChild(Node** node, uint8_t byte, Node* child);
+    static void _removeChild(Node** node, uint8_t byte);
+
+    // Helper function to copy the header of from into a node of another type
+    static void _copyHeader(Node* to, const Node* from);
+
+    // Helper function for recursive removal below *node, returns false if key is missing
+    static bool _remove(Node** node, uint32_t key, size_t depth);
+
+    // Helper functions to find the leaf with the smallest / largest key of a subtree
+    static const Leaf* _minLeaf(const Node* node);
+    static const Leaf* _maxLeaf(const Node* node);
+
+    // Helper function for recursive in-order traversal, calls visit(leaf) in key order
+    template <typename Visit>
+    static void _forEachLeaf(const Node* node, Visit& visit);
+
+    // Helper functions for deep copy and destruction
+    static Node* _copy(const Node* node);
+    static void _destroy(Node* node);
+
+public:
+    // Constructor
+    RadixTree();
+    // Destructor
+    ~RadixTree();
+
+    // Copy Constructor and Assignment Operator (deep copy)
+    RadixTree(const RadixTree& other);
+    RadixTree& operator=(const RadixTree& other);
+
+    // Move Constructor and Assignment Operator (take over the nodes of other, leaving it empty)
+    RadixTree(RadixTree&& other) noexcept;
+    RadixTree& operator=(RadixTree&& other) noexcept;
+
+    // Returns true if the tree is empty.
+    bool isEmpty() const;
+
+    // Returns the number of values stored in the tree.
+    size_t size() const;
+
+    // Inserts a new element to the tree
+    void insert(int value);
+
+    // Returns true if the element exists in the tree, false otherwise.
+    bool search(int value) const;
+
+    // Prints the values in ascending order (in-order traversal).
+    void printInOrder() const;
+
+    // Appends the values in ascending order to out.
+    void appendInOrder(std::vector<int>& out) const;
+
+    // Returns the minimum value in the tree. Throws std::runtime_error if tree is empty.
+    int getMinValue() const;
+
+    // Returns the maximum value in the tree. Throws std::runtime_error if tree is empty.
+    int getMaxValue() const;
+
+    // Removes a value from the tree. Throws std::runtime_error if tree is empty or value not found.
+    void remove(int value);
+
+    // Prints the size of the tree, the number of nodes of every type and their memory.
+    void printStats(std::ostream& os = std::cout) const;
+
+    // Operators
+    // Adds a value to the tree (uses insert function).
+    RadixTree& operator+=(int value);
+    // Prints the tree values in ascending order.
+    friend std::ostream& operator<<(std::ostream& os, const RadixTree& tree);
+};
+
+#endif // RADIX_TREE_H
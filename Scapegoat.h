@@ -0,0 +1,101 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef SCAPEGOAT_H
+#define SCAPEGOAT_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Scapegoat shape maintenance (Galperin and Rivest) for the binary search trees of the project
+// (BinaryTree::setBalance, TreeMap). Node is any node type with left and right links; nodes are
+// only relinked, never copied or allocated.
+//
+// An insert records the links from the root down to the new node. If the node lands deeper
+// than log(n) / log(1 / alpha), some ancestor has a child holding more than alpha of its nodes;
+// the lowest such ancestor is the scapegoat, and its subtree is rebuilt perfectly balanced.
+template <typename Node>
+class Scapegoat {
+private:
+    // Helper to turn the first size nodes of a vine into a tree whose halves differ by at most
+    // one node. Takes the nodes in order from vine; recursion depth is the height of the result.
+    static Node* _vineToTree(Node*& vine, size_t size) {
+        if (size == 0) {
+            return nullptr;
+        }
+        Node* left = _vineToTree(vine, (size - 1) / 2);
+        Node* node = vine;
+        vine = vine->right;
+        node->left = left;
+        node->right = _vineToTree(vine, size - 1 - (size - 1) / 2);
+        return node;
+    }
+
+public:
+    // Returns true if a node depth links below the root breaks the alpha height bound of a tree of size nodes.
+    static bool tooDeep(size_t depth, size_t size, double alpha) {
+        return depth > std::log(static_cast<double>(size)) / std::log(1 / alpha);
+    }
+
+    // Walks up path (the links from the root to the parent of node, node just inserted) and
+    // returns the link of the scapegoat, setting size to its number of nodes.
+    static Node** findScapegoat(const std::vector<Node**>& path, const Node* node, double alpha, size_t& size) {
+        const Node* child = node;
+        size_t child_size = 1;
+        for (size_t i = path.size(); i-- > 0;) {
+            const Node* parent = *path[i];
+            const Node* sibling = parent->left == child ? parent->right : parent->left;
+            size_t parent_size = child_size + 1 + subtreeSize(sibling);
+            if (child_size > alpha * parent_size) {
+                size = parent_size;
+                return path[i];
+            }
+            child = parent;
+            child_size = parent_size;
+        }
+        return nullptr;
+    }
+
+    // Returns the number of nodes of a subtree, without recursion.
+    static size_t subtreeSize(const Node* node) {
+        size_t size = 0;
+        std::vector<const Node*> pending;
+        while (node != nullptr || !pending.empty()) {
+            if (node == nullptr) {
+                node = pending.back();
+                pending.pop_back();
+            }
+            size++;
+            if (node->right != nullptr) {
+                pending.push_back(node->right);
+            }
+            node = node->left;
+        }
+        return size;
+    }
+
+    // Rebuilds the subtree at *link (size nodes) balanced in place: right rotations flatten it
+    // into a vine (every left link empty), one node per rotation, which is then relinked in order.
+    static void rebuild(Node** link, size_t size) {
+        Node** remainder = link;
+        while (*remainder != nullptr) {
+            Node* node = *remainder;
+            if (node->left == nullptr) {
+                remainder = &node->right;
+            }
+            else {
+                Node* left = node->left;
+                node->left = left->right;
+                left->right = node;
+                *remainder = left;
+            }
+        }
+        Node* vine = *link;
+        *link = _vineToTree(vine, size);
+    }
+};
+
+#endif // SCAPEGOAT_H
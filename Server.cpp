@@ -0,0 +1,492 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "Server.h"
+#include "Protocol.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+static const size_t kReadSize = 64 * 1024;
+static const size_t kReadBudget = 256 * 1024;          // bytes read from one client per wakeup
+static const size_t kOutputHighWater = 4 * 1024 * 1024; // pause reading above this much unsent output
+static const int kMaxEvents = 64;
+
+Server::Connection::Connection(int fd)
+    : fd(fd), output_sent(0), closing(false), reading(true), writing(false) {}
+
+#ifdef __linux__
+
+// Set by SIGINT / SIGTERM, checked by the event loop
+static volatile sig_atomic_t g_stop_requested = 0;
+// Write end of the event loop's wake pipe (-1: no loop running)
+static volatile sig_atomic_t g_wake_fd = -1;
+
+// Whichever thread the signal lands on, the byte written to the pipe wakes epoll_wait, and a
+// signal that arrives before the loop waits leaves the byte there, so the stop is never missed
+static void requestStop(int) {
+    g_stop_requested = 1;
+    int wake_fd = g_wake_fd;
+    if (wake_fd >= 0) {
+        int saved = errno;
+        ssize_t ignored = ::write(wake_fd, "", 1);
+        (void)ignored;
+        errno = saved;
+    }
+}
+
+// Throws std::runtime_error describing the failed system call
+static void throwSystemError(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+static void setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        throwSystemError("Cannot make socket non-blocking");
+    }
+}
+
+// Appends the status byte of a response
+static void appendStatus(std::vector<char>& output, ResponseStatus status) {
+    output.push_back(static_cast<char>(status));
+}
+
+// Appends a 32-bit value to a response
+static void appendValue(std::vector<char>& output, uint32_t value) {
+    size_t offset = output.size();
+    output.resize(offset + 4);
+    encodeInt32(&output[offset], value);
+}
+
+// --- Private Helper Functions ---
+
+// Helper to accept every waiting client
+void Server::_accept() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; // EAGAIN: no more clients waiting (other errors: retry on the next event)
+        }
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+        connections.insert(std::make_pair(fd, Connection(fd)));
+        accepted++;
+    }
+}
+
+// Helper to read from a client and execute its complete requests
+// Everything executed here is answered by one write in _flush
+void Server::_handleReadable(Connection& connection) {
+    size_t budget = kReadBudget;
+    while (budget > 0) {
+        size_t filled = connection.input.size();
+        connection.input.resize(filled + kReadSize);
+        ssize_t got = ::read(connection.fd, &connection.input[filled], kReadSize);
+        connection.input.resize(filled + (got > 0 ? got : 0));
+        if (got > 0) {
+            budget -= std::min(budget, static_cast<size_t>(got));
+            continue;
+        }
+        if (got == 0) {
+            connection.closing = true; // the client closed its side, answer what arrived
+        }
+        else if (errno == EINTR) {
+            continue;
+        }
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            connection.closing = true;
+            connection.output.clear();
+            connection.output_sent = 0;
+            connection.input.clear();
+        }
+        break;
+    }
+
+    size_t parsed = 0;
+    const char* data = connection.input.data();
+    size_t available = connection.input.size();
+    while (parsed < available) {
+        size_t length = requestLength(static_cast<uint8_t>(data[parsed]));
+        if (length == 0) {
+            appendStatus(connection.output, ResponseStatus::BadRequest);
+            connection.closing = true;
+            parsed = available;
+            break;
+        }
+        if (available - parsed < length) {
+            break; // the rest of the request is still on its way
+        }
+        if (!_execute(data + parsed, connection.output)) {
+            connection.closing = true;
+            parsed = available;
+            break;
+        }
+        parsed += length;
+        requests++;
+    }
+    connection.input.erase(connection.input.begin(), connection.input.begin() + parsed);
+}
+
+// Helper to execute one request and append its response
+bool Server::_execute(const char* request, std::vector<char>& output) {
+    Opcode opcode = static_cast<Opcode>(request[0]);
+    TargetContainer target = static_cast<TargetContainer>(request[1]);
+    if (target != TargetContainer::Tree && target != TargetContainer::List) {
+        appendStatus(output, ResponseStatus::BadRequest);
+        return false;
+    }
+    bool on_tree = target == TargetContainer::Tree;
+    // Min and Max carry no value
+    int value = requestLength(request[0]) > 2 ? static_cast<int>(decodeInt32(request + 2)) : 0;
+
+    switch (opcode) {
+        case Opcode::Insert:
+            if (on_tree) {
+                tree.insert(value);
+            } else {
+                list.insert(value);
+            }
+            appendStatus(output, ResponseStatus::Ok);
+            break;
+        case Opcode::Search: {
+            bool found = on_tree ? tree.search(value) : list.search(value);
+            appendStatus(output, found ? ResponseStatus::Ok : ResponseStatus::NotFound);
+            break;
+        }
+        case Opcode::Remove: {
+            bool removed;
+            if (on_tree) {
+                try {
+                    tree.remove(value);
+                    removed = true;
+                } catch (const std::runtime_error&) {
+                    removed = false;
+                }
+            } else {
+                removed = list.remove(value);
+            }
+            appendStatus(output, removed ? ResponseStatus::Ok : ResponseStatus::NotFound);
+            break;
+        }
+        case Opcode::Min:
+        case Opcode::Max:
+            if (on_tree ? tree.isEmpty() : list.isEmpty()) {
+                appendStatus(output, ResponseStatus::Empty);
+                break;
+            }
+            appendStatus(output, ResponseStatus::Ok);
+            if (opcode == Opcode::Min) {
+                appendValue(output, static_cast<uint32_t>(on_tree ? tree.getMinValue() : list.getFirst()));
+            } else {
+                appendValue(output, static_cast<uint32_t>(on_tree ? tree.getMaxValue() : list.getLast()));
+            }
+            break;
+        case Opcode::Range: {
+            int high = static_cast<int>(decodeInt32(request + 6));
+            range_values.clear();
+            if (value <= high) {
+                // One value past the limit tells a truncated range from an exact fit
+                if (on_tree) {
+                    tree.appendRange(value, high, range_values, kMaxRangeValues + 1);
+                } else {
+                    list.appendRange(value, high, range_values, kMaxRangeValues + 1);
+                }
+            }
+            bool truncated = range_values.size() > kMaxRangeValues;
+            if (truncated) {
+                range_values.pop_back();
+            }
+            appendStatus(output, truncated ? ResponseStatus::Truncated : ResponseStatus::Ok);
+            appendValue(output, static_cast<uint32_t>(range_values.size()));
+            size_t offset = output.size();
+            output.resize(offset + 4 * range_values.size());
+            for (size_t i = 0; i < range_values.size(); i++) {
+                encodeInt32(&output[offset + 4 * i], static_cast<uint32_t>(range_values[i]));
+            }
+            break;
+        }
+        default:
+            appendStatus(output, ResponseStatus::BadRequest);
+            return false;
+    }
+    return true;
+}
+
+// Helper to send as much pending output as the socket takes
+void Server::_flush(Connection& connection) {
+    while (connection.output_sent < connection.output.size()) {
+        ssize_t sent = ::send(connection.fd, &connection.output[connection.output_sent],
+                              connection.output.size() - connection.output_sent, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection.output_sent += sent;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        // The client is gone, drop what it did not receive
+        connection.output.clear();
+        connection.output_sent = 0;
+        connection.closing = true;
+        return;
+    }
+    if (connection.output_sent > 0) {
+        batches++;
+    }
+    if (connection.output_sent == connection.output.size()) {
+        connection.output.clear();
+        connection.output_sent = 0;
+    }
+    else if (connection.output_sent >= kReadSize) {
+        // Drop the sent prefix so the buffer does not grow without bound
+        connection.output.erase(connection.output.begin(), connection.output.begin() + connection.output_sent);
+        connection.output_sent = 0;
+    }
+}
+
+// Helper to register the events a connection currently needs
+void Server::_updateEvents(Connection& connection) {
+    size_t unsent = connection.output.size() - connection.output_sent;
+    bool want_read = !connection.closing && unsent < kOutputHighWater;
+    bool want_write = unsent > 0;
+    if (want_read == connection.reading && want_write == connection.writing) {
+        return;
+    }
+    epoll_event event;
+    event.events = 0;
+    if (want_read) {
+        event.events |= EPOLLIN;
+    }
+    if (want_write) {
+        event.events |= EPOLLOUT;
+    }
+    event.data.fd = connection.fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection.fd, &event);
+    connection.reading = want_read;
+    connection.writing = want_write;
+}
+
+// Helper to close a client and forget its state
+void Server::_close(int fd) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+}
+
+// --- Public Member Functions ---
+
+// Constructor, binds and listens on the socket path
+Server::Server(BinaryTree& tree, SortedList& list, const std::string& socket_path)
+    : tree(tree), list(list), socket_path(socket_path), listen_fd(-1), epoll_fd(-1),
+      accepted(0), requests(0), batches(0) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path is empty or too long: " + socket_path);
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+
+    // A socket file left behind by a previous run would make bind fail
+    struct stat info;
+    if (stat(socket_path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(socket_path.c_str());
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        throwSystemError("Cannot create socket");
+    }
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        int saved = errno;
+        ::close(listen_fd);
+        errno = saved;
+        throwSystemError("Cannot listen on " + socket_path);
+    }
+    // From here on the socket file exists and every failure removes it
+    if (listen(listen_fd, SOMAXCONN) < 0) {
+        int saved = errno;
+        ::close(listen_fd);
+        unlink(socket_path.c_str());
+        errno = saved;
+        throwSystemError("Cannot listen on " + socket_path);
+    }
+    try {
+        setNonBlocking(listen_fd);
+    } catch (...) {
+        ::close(listen_fd);
+        unlink(socket_path.c_str());
+        throw;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        int saved = errno;
+        ::close(listen_fd);
+        unlink(socket_path.c_str());
+        errno = saved;
+        throwSystemError("Cannot create epoll instance");
+    }
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) < 0) {
+        int saved = errno;
+        ::close(epoll_fd);
+        ::close(listen_fd);
+        unlink(socket_path.c_str());
+        errno = saved;
+        throwSystemError("Cannot watch " + socket_path);
+    }
+}
+
+// Destructor, closes every connection and removes the socket file
+Server::~Server() {
+    for (std::unordered_map<int, Connection>::iterator it = connections.begin(); it != connections.end(); ++it) {
+        ::close(it->first);
+    }
+    ::close(epoll_fd);
+    ::close(listen_fd);
+    unlink(socket_path.c_str());
+}
+
+// Installs the stop handlers and the wake pipe, watched by epoll_fd, for one run of the event
+// loop, and puts everything back however the loop ends
+class StopSignals {
+public:
+    explicit StopSignals(int epoll_fd) : epoll_fd(epoll_fd) {
+        if (pipe2(pipe_fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+            throwSystemError("Cannot create wake pipe");
+        }
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = pipe_fds[0];
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event) < 0) {
+            int saved = errno;
+            ::close(pipe_fds[0]);
+            ::close(pipe_fds[1]);
+            errno = saved;
+            throwSystemError("Cannot watch wake pipe");
+        }
+        g_stop_requested = 0;
+        g_wake_fd = pipe_fds[1];
+
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = requestStop;
+        sigaction(SIGINT, &action, &old_int);
+        sigaction(SIGTERM, &action, &old_term);
+    }
+
+    ~StopSignals() {
+        sigaction(SIGINT, &old_int, nullptr);
+        sigaction(SIGTERM, &old_term, nullptr);
+        g_wake_fd = -1;
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe_fds[0], nullptr);
+        ::close(pipe_fds[0]);
+        ::close(pipe_fds[1]);
+    }
+
+    int wakeFd() const {
+        return pipe_fds[0];
+    }
+
+private:
+    int epoll_fd;
+    int pipe_fds[2];
+    struct sigaction old_int;
+    struct sigaction old_term;
+
+    StopSignals(const StopSignals&);
+    StopSignals& operator=(const StopSignals&);
+};
+
+// Event loop, runs until SIGINT or SIGTERM
+void Server::run() {
+    StopSignals stop_signals(epoll_fd);
+    epoll_event events[kMaxEvents];
+    while (!g_stop_requested) {
+        int ready = epoll_wait(epoll_fd, events, kMaxEvents, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throwSystemError("epoll_wait failed");
+        }
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd) {
+                _accept();
+                continue;
+            }
+            if (fd == stop_signals.wakeFd()) {
+                continue; // g_stop_requested is set, the loop ends after this batch
+            }
+            std::unordered_map<int, Connection>::iterator it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& connection = it->second;
+            // Paused reads stay paused: epoll reports HUP and ERR even without EPOLLIN
+            if ((events[i].events & EPOLLIN) && connection.reading) {
+                _handleReadable(connection);
+            }
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                // The client is gone; a failing send drops the output it can no longer receive
+                connection.closing = true;
+            }
+            _flush(connection);
+            if (connection.closing && connection.output.empty()) {
+                _close(fd);
+            }
+            else {
+                _updateEvents(connection);
+            }
+        }
+    }
+}
+
+#else // !__linux__
+
+Server::Server(BinaryTree& tree, SortedList& list, const std::string& socket_path)
+    : tree(tree), list(list), socket_path(socket_path), listen_fd(-1), epoll_fd(-1),
+      accepted(0), requests(0), batches(0) {
+    throw std::runtime_error("Server mode needs epoll and is only available on Linux.");
+}
+
+Server::~Server() {}
+
+void Server::run() {}
+
+#endif // __linux__
+
+// Print the server counters
+void Server::printStats(std::ostream& os) const {
+    os << "Server: socket=" << socket_path << " clients=" << connections.size() << " accepted=" << accepted
+       << " requests=" << requests << " batches=" << batches << "\n";
+}
@@ -0,0 +1,90 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "BinaryTree.h"
+#include "SortedList.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Serves a BinaryTree and a SortedList over a Unix domain socket using the
+// binary protocol of Protocol.h.
+//
+// One thread runs an epoll event loop over every client, so the containers need
+// no locking. All complete requests that arrive in one read are executed back to
+// back and their responses go out in a single write (response batching); clients
+// may pipeline as many requests as they like. A client that stops reading has its
+// reads paused until its pending responses drain.
+//
+// Linux only (epoll); elsewhere the constructor throws std::runtime_error.
+class Server {
+private:
+    struct Connection {
+        int fd;
+        std::vector<char> input;     // received bytes not parsed yet
+        std::vector<char> output;    // responses not sent yet
+        size_t output_sent;          // bytes of output already sent
+        bool closing;                // close once output is sent (bad request or peer closed)
+        bool reading;                // registered for EPOLLIN
+        bool writing;                // registered for EPOLLOUT
+
+        Connection(int fd);
+    };
+
+    BinaryTree& tree;
+    SortedList& list;
+    std::string socket_path;
+    int listen_fd;
+    int epoll_fd;
+    std::unordered_map<int, Connection> connections;
+    std::vector<int> range_values;   // scratch for Range requests
+
+    unsigned long long accepted;
+    unsigned long long requests;
+    unsigned long long batches;      // writes that carried responses
+
+    // Helper to accept every waiting client
+    void _accept();
+
+    // Helper to read from a client and execute its complete requests
+    void _handleReadable(Connection& connection);
+
+    // Helper to execute one request and append its response, returns false on a bad request
+    bool _execute(const char* request, std::vector<char>& output);
+
+    // Helper to send as much pending output as the socket takes
+    void _flush(Connection& connection);
+
+    // Helper to register the events a connection currently needs
+    void _updateEvents(Connection& connection);
+
+    // Helper to close a client and forget its state
+    void _close(int fd);
+
+    // A server owns its socket and file descriptors
+    Server(const Server&);
+    Server& operator=(const Server&);
+
+public:
+    // Listens on socket_path (replacing a stale socket file) and serves tree and list,
+    // which must outlive the server.
+    Server(BinaryTree& tree, SortedList& list, const std::string& socket_path);
+
+    // Closes every connection and removes the socket file.
+    ~Server();
+
+    // Serves clients until SIGINT or SIGTERM.
+    void run();
+
+    // Prints the connection, request and batch counters.
+    void printStats(std::ostream& os = std::cout) const;
+};
+
+#endif // SERVER_H
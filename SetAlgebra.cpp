@@ -0,0 +1,151 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "SetAlgebra.h"
+#include <algorithm>
+#include <thread>
+
+// Inputs smaller than this are not worth a thread
+static const size_t kParallelThreshold = 1 << 16;
+
+bool keepsOnlyFirst(SetOperation op) {
+    return op == SetOperation::Union || op == SetOperation::Difference ||
+           op == SetOperation::SymmetricDifference;
+}
+
+bool keepsOnlySecond(SetOperation op) {
+    return op == SetOperation::Union || op == SetOperation::SymmetricDifference;
+}
+
+bool keepsBoth(SetOperation op) {
+    return op == SetOperation::Union || op == SetOperation::Intersection;
+}
+
+// Appends value unless it repeats the last output (the output is always ascending)
+static void emit(std::vector<int>& out, int value) {
+    if (out.empty() || out.back() != value) {
+        out.push_back(value);
+    }
+}
+
+// Returns the first position at or after from whose value is not less than key,
+// probing from + 1, + 2, + 4, ... before binary searching the last gap
+static size_t gallop(const int* values, size_t size, size_t from, int key) {
+    if (from >= size || values[from] >= key) {
+        return from;
+    }
+    size_t low = from;  // values[low] < key
+    size_t step = 1;
+    size_t high = from + step;
+    while (high < size && values[high] < key) {
+        low = high;
+        step *= 2;
+        high = from + step;
+    }
+    if (high > size) {
+        high = size;
+    }
+    return std::lower_bound(values + low + 1, values + high, key) - values;
+}
+
+void sortedSetOperation(SetOperation op, const int* a, size_t a_size, const int* b, size_t b_size,
+                        std::vector<int>& out) {
+    // The smaller input drives the merge; remember which side each one came from
+    bool a_is_small = a_size <= b_size;
+    const int* small = a_is_small ? a : b;
+    const int* large = a_is_small ? b : a;
+    size_t small_size = a_is_small ? a_size : b_size;
+    size_t large_size = a_is_small ? b_size : a_size;
+    bool keep_small_only = a_is_small ? keepsOnlyFirst(op) : keepsOnlySecond(op);
+    bool keep_large_only = a_is_small ? keepsOnlySecond(op) : keepsOnlyFirst(op);
+    bool keep_both = keepsBoth(op);
+
+    size_t j = 0;
+    for (size_t i = 0; i < small_size; i++) {
+        int key = small[i];
+        if (i > 0 && small[i - 1] == key) {
+            continue;
+        }
+        size_t next = gallop(large, large_size, j, key);
+        if (keep_large_only) {
+            for (; j < next; j++) {
+                emit(out, large[j]);
+            }
+        }
+        j = next;
+        if (j < large_size && large[j] == key) {
+            if (keep_both) {
+                emit(out, key);
+            }
+            while (j < large_size && large[j] == key) {
+                j++;
+            }
+        }
+        else if (keep_small_only) {
+            emit(out, key);
+        }
+    }
+    if (keep_large_only) {
+        for (; j < large_size; j++) {
+            emit(out, large[j]);
+        }
+    }
+}
+
+void parallelSetOperation(SetOperation op, const std::vector<int>& a, const std::vector<int>& b,
+                          std::vector<int>& out, unsigned threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    size_t total = a.size() + b.size();
+    if (threads <= 1 || total < kParallelThreshold) {
+        sortedSetOperation(op, a.data(), a.size(), b.data(), b.size(), out);
+        return;
+    }
+
+    // Split the key range at evenly spaced keys of the larger input. Both inputs are
+    // cut with lower_bound, so every copy of a key lands in the same slice and the
+    // slices can be merged independently and simply concatenated.
+    const std::vector<int>& larger = a.size() >= b.size() ? a : b;
+    std::vector<size_t> a_cuts(1, 0);
+    std::vector<size_t> b_cuts(1, 0);
+    for (unsigned t = 1; t < threads; t++) {
+        int pivot = larger[larger.size() * t / threads];
+        size_t a_cut = std::lower_bound(a.begin(), a.end(), pivot) - a.begin();
+        size_t b_cut = std::lower_bound(b.begin(), b.end(), pivot) - b.begin();
+        if (a_cut == a_cuts.back() && b_cut == b_cuts.back()) {
+            continue; // a run of equal keys spans the cut
+        }
+        a_cuts.push_back(a_cut);
+        b_cuts.push_back(b_cut);
+    }
+    a_cuts.push_back(a.size());
+    b_cuts.push_back(b.size());
+
+    size_t slices = a_cuts.size() - 1;
+    std::vector<std::vector<int> > parts(slices);
+    std::vector<std::thread> workers;
+    for (size_t s = 1; s < slices; s++) {
+        workers.push_back(std::thread([&, s] {
+            sortedSetOperation(op, a.data() + a_cuts[s], a_cuts[s + 1] - a_cuts[s],
+                               b.data() + b_cuts[s], b_cuts[s + 1] - b_cuts[s], parts[s]);
+        }));
+    }
+    sortedSetOperation(op, a.data(), a_cuts[1], b.data(), b_cuts[1], parts[0]);
+    for (size_t w = 0; w < workers.size(); w++) {
+        workers[w].join();
+    }
+
+    size_t offset = out.size();
+    size_t produced = 0;
+    for (size_t s = 0; s < slices; s++) {
+        produced += parts[s].size();
+    }
+    out.resize(offset + produced);
+    for (size_t s = 0; s < slices; s++) {
+        std::copy(parts[s].begin(), parts[s].end(), out.begin() + offset);
+        offset += parts[s].size();
+    }
+}
@@ -0,0 +1,38 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef SET_ALGEBRA_H
+#define SET_ALGEBRA_H
+
+#include <cstddef>
+#include <vector>
+
+// Set operations over the distinct keys of two containers.
+enum class SetOperation {
+    Union,
+    Intersection,
+    Difference,          // keys of the first input that are not in the second
+    SymmetricDifference  // keys in exactly one of the inputs
+};
+
+// Returns true if op keeps keys found only in the first input / only in the second / in both.
+bool keepsOnlyFirst(SetOperation op);
+bool keepsOnlySecond(SetOperation op);
+bool keepsBoth(SetOperation op);
+
+// Appends op(a, b) to out in ascending order without duplicates.
+// a and b must be sorted ascending and may contain duplicates. The smaller input
+// drives the merge and the larger one is searched with exponential (galloping)
+// search, so very uneven inputs cost O(m log(n / m)) comparisons instead of O(n + m).
+void sortedSetOperation(SetOperation op, const int* a, size_t a_size, const int* b, size_t b_size,
+                        std::vector<int>& out);
+
+// Same result as sortedSetOperation, but splits the key range into independent
+// slices and merges them on separate threads. threads == 0 uses every hardware thread.
+// Small inputs are merged on the calling thread.
+void parallelSetOperation(SetOperation op, const std::vector<int>& a, const std::vector<int>& b,
+                          std::vector<int>& out, unsigned threads = 0);
+
+#endif // SET_ALGEBRA_H
@@ -0,0 +1,443 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "ShardedTree.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pins the calling thread to one core. Only supported on Linux; elsewhere the
+// scheduler decides and first-touch placement follows wherever the thread runs.
+static void pinToCore(unsigned core) {
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#else
+    (void)core;
+#endif
+}
+
+// --- Private Helper Functions ---
+
+// Holds every shard lock
+// Index order matches the single shard locks, so it never deadlocks with them
+class ShardedTree::AllShardsLock {
+public:
+    explicit AllShardsLock(const ShardedTree& tree) : tree(tree) {
+        for (size_t i = 0; i < tree.max_shards; i++) {
+            tree.shard_locks[i].lock();
+        }
+    }
+    ~AllShardsLock() {
+        for (size_t i = tree.max_shards; i > 0; i--) {
+            tree.shard_locks[i - 1].unlock();
+        }
+    }
+
+private:
+    const ShardedTree& tree;
+
+    AllShardsLock(const AllShardsLock&);
+    AllShardsLock& operator=(const AllShardsLock&);
+};
+
+// Helper to find the shard that owns a key (the last shard whose lower bound is <= key)
+// During a layout change the answer may be stale, but it is always a valid index
+size_t ShardedTree::_shardFor(int key) const {
+    size_t low = 0;
+    size_t high = shard_count.load();
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (lower_bounds[middle].load() <= key) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Helper to lock the shard that owns a key
+// The layout only changes under every lock, so once the shard lock is held and the version
+// has not moved since routing, the shard still owns the key
+size_t ShardedTree::_lockShardFor(int key, std::unique_lock<std::mutex>& lock) const {
+    for (;;) {
+        unsigned long long version = layout_version.load();
+        size_t shard = _shardFor(key);
+        std::unique_lock<std::mutex> candidate(shard_locks[shard]);
+        if (layout_version.load() == version) {
+            lock.swap(candidate);
+            return shard;
+        }
+    }
+}
+
+// Helper to count an operation routed to a shard
+void ShardedTree::_recordOperation(size_t shard) const {
+    shard_ops[shard]++;
+    ops_since_check++;
+}
+
+// Helper to run the hot shard check once rebalance_interval operations have passed
+// Resetting the counter elects the one thread that runs the check
+void ShardedTree::_maybeRebalance() const {
+    unsigned long long interval = rebalance_interval.load();
+    unsigned long long seen = ops_since_check.load();
+    if (interval == 0 || seen < interval || !ops_since_check.compare_exchange_strong(seen, 0)) {
+        return;
+    }
+    AllShardsLock lock(*this);
+    _rebalance();
+}
+
+// Helper for the hot shard check
+// Splits the hottest shard if it is hot enough, then merges the coldest neighbouring pair
+bool ShardedTree::_rebalance() const {
+    unsigned long long total = 0;
+    size_t hottest = 0;
+    for (size_t i = 0; i < shard_ops.size(); i++) {
+        total += shard_ops[i];
+        if (shard_ops[i] > shard_ops[hottest]) {
+            hottest = i;
+        }
+    }
+    double mean = static_cast<double>(total) / shard_ops.size();
+    bool changed = false;
+    if (total > 0 && shard_ops[hottest] > hot_factor * mean) {
+        if (shards.size() == max_shards) {
+            // No room for another shard: first merge a pair that leaves the hot shard alone
+            size_t coldest = _coldestPair(hottest, hottest);
+            if (coldest < shards.size()) {
+                _mergeShards(coldest);
+                if (coldest < hottest) {
+                    hottest--;
+                }
+                changed = true;
+            }
+        }
+        if (shards.size() < max_shards && _splitShard(hottest)) {
+            changed = true;
+            // Merge the coldest adjacent pair that does not involve the two new halves
+            if (shards.size() > target_shards) {
+                size_t coldest = _coldestPair(hottest, hottest + 1);
+                if (coldest < shards.size()) {
+                    _mergeShards(coldest);
+                }
+            }
+        }
+        if (changed) {
+            rebalance_count++;
+            layout_version++;
+        }
+    }
+    // Age the load so the next check reflects recent traffic
+    for (size_t i = 0; i < shard_ops.size(); i++) {
+        shard_ops[i] /= 2;
+    }
+    return changed;
+}
+
+// Helper to find the coldest adjacent pair outside a range of shards
+size_t ShardedTree::_coldestPair(size_t avoid_first, size_t avoid_last) const {
+    size_t coldest = shards.size();
+    for (size_t i = 0; i + 1 < shards.size(); i++) {
+        if (i + 1 >= avoid_first && i <= avoid_last) {
+            continue;
+        }
+        if (coldest == shards.size() ||
+            shard_ops[i] + shard_ops[i + 1] < shard_ops[coldest] + shard_ops[coldest + 1]) {
+            coldest = i;
+        }
+    }
+    return coldest;
+}
+
+// Helper to split one shard in two at the median key
+// Every copy of the median goes to the same side, so the bounds stay strict
+bool ShardedTree::_splitShard(size_t index) const {
+    std::vector<int> values;
+    values.reserve(shards[index].size());
+    shards[index].appendInOrder(values);
+    if (values.size() < 2) {
+        return false;
+    }
+    int median = values[values.size() / 2];
+    size_t cut = std::lower_bound(values.begin(), values.end(), median) - values.begin();
+    if (cut == 0) {
+        cut = std::upper_bound(values.begin(), values.end(), median) - values.begin();
+    }
+    if (cut == values.size()) {
+        return false; // every value is equal, nothing to split
+    }
+
+    std::vector<int> upper_half(values.begin() + cut, values.end());
+    values.resize(cut);
+    shards[index] = BinaryTree::fromSorted(values);
+    shards.insert(shards.begin() + index + 1, BinaryTree::fromSorted(upper_half));
+    for (size_t i = shards.size() - 1; i > index + 1; i--) {
+        lower_bounds[i].store(lower_bounds[i - 1].load());
+    }
+    lower_bounds[index + 1].store(upper_half.front());
+    shard_count.store(shards.size());
+    unsigned long long half_load = shard_ops[index] / 2;
+    shard_ops[index] -= half_load;
+    shard_ops.insert(shard_ops.begin() + index + 1, half_load);
+    return true;
+}
+
+// Helper to merge shard index + 1 into shard index
+// The ranges are adjacent, so the in-order values simply concatenate
+void ShardedTree::_mergeShards(size_t index) const {
+    std::vector<int> values;
+    values.reserve(shards[index].size() + shards[index + 1].size());
+    shards[index].appendInOrder(values);
+    shards[index + 1].appendInOrder(values);
+    shards[index] = BinaryTree::fromSorted(values);
+    shards.erase(shards.begin() + index + 1);
+    for (size_t i = index + 1; i < shards.size(); i++) {
+        lower_bounds[i].store(lower_bounds[i + 1].load());
+    }
+    shard_count.store(shards.size());
+    shard_ops[index] += shard_ops[index + 1];
+    shard_ops.erase(shard_ops.begin() + index + 1);
+}
+
+// Helpers for the whole-tree queries
+bool ShardedTree::_isEmpty() const {
+    for (size_t i = 0; i < shards.size(); i++) {
+        if (!shards[i].isEmpty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t ShardedTree::_size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shards.size(); i++) {
+        total += shards[i].size();
+    }
+    return total;
+}
+
+// --- Public Member Functions ---
+
+// Constructor, splits the expected key range into equal shards
+// One spare slot lets the rebalancer split a shard before it merges another pair
+ShardedTree::ShardedTree(size_t shard_count, int expected_min, int expected_max)
+    : max_shards(0), shard_count(0), layout_version(0), ops_since_check(0), rebalance_interval(1 << 16),
+      hot_factor(2.0), rebalance_count(0) {
+    if (shard_count == 0) {
+        shard_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (expected_min > expected_max) {
+        throw std::invalid_argument("Sharded tree range is empty.");
+    }
+    long long width = static_cast<long long>(expected_max) - expected_min + 1;
+    if (static_cast<long long>(shard_count) > width) {
+        shard_count = static_cast<size_t>(width);
+    }
+    target_shards = shard_count;
+    max_shards = shard_count + 1;
+    shard_locks.reset(new std::mutex[max_shards]);
+    lower_bounds.reset(new std::atomic<int>[max_shards]);
+    shards.reserve(max_shards);
+    shards.resize(shard_count);
+    shard_ops.assign(shard_count, 0);
+    lower_bounds[0].store(INT_MIN);
+    for (size_t i = 1; i < max_shards; i++) {
+        lower_bounds[i].store(i < shard_count ? static_cast<int>(expected_min + width * static_cast<long long>(i) / shard_count)
+                                              : INT_MAX);
+    }
+    this->shard_count.store(shard_count);
+}
+
+// Check if every shard is empty
+bool ShardedTree::isEmpty() const {
+    AllShardsLock lock(*this);
+    return _isEmpty();
+}
+
+// Total number of values
+size_t ShardedTree::size() const {
+    AllShardsLock lock(*this);
+    return _size();
+}
+
+size_t ShardedTree::shardCount() const {
+    return shard_count.load();
+}
+
+// Insert a value into the shard owning its range
+void ShardedTree::insert(int value) {
+    {
+        std::unique_lock<std::mutex> lock;
+        size_t shard = _lockShardFor(value, lock);
+        shards[shard].insert(value);
+        _recordOperation(shard);
+    }
+    _maybeRebalance();
+}
+
+// Insert many values, one pinned worker per shard
+// Every shard is locked for the whole batch, each worker touching only its own shard
+void ShardedTree::bulkInsert(const std::vector<int>& values) {
+    {
+        AllShardsLock lock(*this);
+        // Route every value on the calling thread
+        std::vector<std::vector<int> > buckets(shards.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            buckets[_shardFor(values[i])].push_back(values[i]);
+        }
+
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> workers;
+        for (size_t s = 0; s < shards.size(); s++) {
+            if (buckets[s].empty()) {
+                continue;
+            }
+            workers.push_back(std::thread([this, s, cores, &buckets] {
+                pinToCore(static_cast<unsigned>(s % cores));
+                std::vector<int>& bucket = buckets[s];
+                BinaryTree& shard = shards[s];
+                if (bucket.size() * 4 >= shard.size()) {
+                    // A large batch: merge with the existing values and rebuild balanced
+                    std::sort(bucket.begin(), bucket.end());
+                    std::vector<int> existing;
+                    existing.reserve(shard.size());
+                    shard.appendInOrder(existing);
+                    std::vector<int> merged(existing.size() + bucket.size());
+                    std::merge(existing.begin(), existing.end(), bucket.begin(), bucket.end(), merged.begin());
+                    shard = BinaryTree::fromSorted(merged, 1);
+                }
+                else {
+                    for (size_t i = 0; i < bucket.size(); i++) {
+                        shard.insert(bucket[i]);
+                    }
+                }
+            }));
+        }
+        for (size_t w = 0; w < workers.size(); w++) {
+            workers[w].join();
+        }
+        for (size_t s = 0; s < shards.size(); s++) {
+            shard_ops[s] += buckets[s].size();
+            ops_since_check += buckets[s].size();
+        }
+    }
+    _maybeRebalance();
+}
+
+// Search for a value in the shard owning its range
+bool ShardedTree::search(int value) const {
+    bool found;
+    {
+        std::unique_lock<std::mutex> lock;
+        size_t shard = _lockShardFor(value, lock);
+        _recordOperation(shard);
+        found = shards[shard].search(value);
+    }
+    _maybeRebalance();
+    return found;
+}
+
+// Remove a value from the shard owning its range
+void ShardedTree::remove(int value) {
+    {
+        std::unique_lock<std::mutex> lock;
+        size_t shard = _lockShardFor(value, lock);
+        if (shards[shard].isEmpty()) {
+            throw std::runtime_error("Value not found in tree for removal.");
+        }
+        shards[shard].remove(value);
+        _recordOperation(shard);
+    }
+    _maybeRebalance();
+}
+
+// Get the minimum value (first non-empty shard)
+int ShardedTree::getMinValue() const {
+    AllShardsLock lock(*this);
+    for (size_t i = 0; i < shards.size(); i++) {
+        if (!shards[i].isEmpty()) {
+            return shards[i].getMinValue();
+        }
+    }
+    throw std::runtime_error("Attempted to get min value from an empty tree.");
+}
+
+// Get the maximum value (last non-empty shard)
+int ShardedTree::getMaxValue() const {
+    AllShardsLock lock(*this);
+    for (size_t i = shards.size(); i > 0; i--) {
+        if (!shards[i - 1].isEmpty()) {
+            return shards[i - 1].getMaxValue();
+        }
+    }
+    throw std::runtime_error("Attempted to get max value from an empty tree.");
+}
+
+// Append every value in ascending order (the shards are ordered by range)
+void ShardedTree::appendInOrder(std::vector<int>& out) const {
+    AllShardsLock lock(*this);
+    for (size_t i = 0; i < shards.size(); i++) {
+        shards[i].appendInOrder(out);
+    }
+}
+
+// Print the values in ascending order
+void ShardedTree::printInOrder() const {
+    std::cout << *this << std::endl;
+}
+
+// Configure automatic rebalancing
+void ShardedTree::setRebalancing(unsigned long long interval, double factor) {
+    if (factor <= 1.0) {
+        throw std::invalid_argument("Hot shard factor must be greater than 1.");
+    }
+    AllShardsLock lock(*this);
+    rebalance_interval.store(interval);
+    hot_factor = factor;
+}
+
+// Run the hot shard check now
+bool ShardedTree::rebalance() {
+    AllShardsLock lock(*this);
+    ops_since_check.store(0);
+    return _rebalance();
+}
+
+// Print the shard statistics
+void ShardedTree::printStats(std::ostream& os) const {
+    AllShardsLock lock(*this);
+    os << "ShardedTree: size=" << _size() << " shards=" << shards.size()
+       << " rebalances=" << rebalance_count << "\n";
+    for (size_t i = 0; i < shards.size(); i++) {
+        os << "  shard " << i << ": lower=" << lower_bounds[i].load() << " size=" << shards[i].size()
+           << " load=" << shard_ops[i] << "\n";
+    }
+}
+
+// Prints the values of every shard in order
+std::ostream& operator<<(std::ostream& os, const ShardedTree& sharded) {
+    ShardedTree::AllShardsLock lock(sharded);
+    if (sharded._isEmpty()) {
+        os << "Tree is empty.";
+        return os;
+    }
+    for (size_t i = 0; i < sharded.shards.size(); i++) {
+        if (!sharded.shards[i].isEmpty()) {
+            os << sharded.shards[i];
+        }
+    }
+    return os;
+}
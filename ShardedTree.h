@@ -0,0 +1,145 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef SHARDED_TREE_H
+#define SHARDED_TREE_H
+
+#include "BinaryTree.h"
+#include <atomic>
+#include <climits>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ShardedTree;
+
+// Forward declaration of operator<< for friend declaration
+std::ostream& operator<<(std::ostream& os, const ShardedTree& sharded);
+
+// A BinaryTree partitioned by key range into independent shards.
+// Shard i holds the keys in [lower_bounds[i], lower_bounds[i + 1]), so single
+// operations are routed by a binary search over the bounds and an in-order walk
+// of the shards one after the other is a global in-order walk.
+//
+// bulkInsert runs one worker thread per shard. Each worker is pinned to a core
+// (on Linux) and allocates its shard's nodes itself, so under the default
+// first-touch policy a shard's memory lives on the NUMA node of its core.
+//
+// Every operation is thread safe. Each shard has its own lock, so insert, search and remove
+// on different shards run in parallel and only operations on the same shard wait for each
+// other. The bounds are read without a lock to route a key; the shard layout only changes
+// while every shard lock is held (rebalancing, bulkInsert), and a router that raced with such
+// a change sees the layout version move and routes again. Operations over all shards (size,
+// min / max, the in-order walks) hold every lock, so they see one consistent state.
+class ShardedTree {
+private:
+    // Holds every shard lock, taken in index order
+    class AllShardsLock;
+
+    // Searches also count load and may rebalance, so the layout is mutable even through const
+    mutable std::vector<BinaryTree> shards;
+    size_t max_shards;                                  // capacity of the lock and bound arrays
+    std::unique_ptr<std::mutex[]> shard_locks;          // shard_locks[i] guards shards[i] and shard_ops[i]
+    std::unique_ptr<std::atomic<int>[]> lower_bounds;   // lower_bounds[0] is always INT_MIN
+    mutable std::atomic<size_t> shard_count;
+    mutable std::atomic<unsigned long long> layout_version; // bumped by every change of the bounds
+    mutable std::vector<unsigned long long> shard_ops;  // operations routed to each shard since the last rebalance
+    mutable std::atomic<unsigned long long> ops_since_check;
+    std::atomic<unsigned long long> rebalance_interval; // operations between two hot shard checks
+    double hot_factor;                                  // a shard is hot above hot_factor * the mean load
+    size_t target_shards;                               // shard count the rebalancer keeps
+    mutable size_t rebalance_count;
+
+    // Helper to find the shard that owns a key, from the bounds as they are right now
+    size_t _shardFor(int key) const;
+
+    // Helper to lock the shard that owns a key, returns its index
+    size_t _lockShardFor(int key, std::unique_lock<std::mutex>& lock) const;
+
+    // Helper to count an operation routed to a shard (caller holds the shard lock)
+    void _recordOperation(size_t shard) const;
+
+    // Helper to run the hot shard check once rebalance_interval operations have passed
+    // (caller holds no lock)
+    void _maybeRebalance() const;
+
+    // Helper for the hot shard check (caller holds every lock)
+    bool _rebalance() const;
+
+    // Helper to find the coldest adjacent pair with no shard in [avoid_first, avoid_last],
+    // returns the index of its first shard or the shard count if there is none
+    size_t _coldestPair(size_t avoid_first, size_t avoid_last) const;
+
+    // Helper to split one shard in two at the median key, returns false if it cannot be split
+    bool _splitShard(size_t index) const;
+
+    // Helper to merge shard index + 1 into shard index
+    void _mergeShards(size_t index) const;
+
+    // Helpers for the whole-tree queries (caller holds every lock)
+    bool _isEmpty() const;
+    size_t _size() const;
+
+    // A sharded tree owns its locks
+    ShardedTree(const ShardedTree&);
+    ShardedTree& operator=(const ShardedTree&);
+
+public:
+    // Creates shard_count shards (0: one per hardware thread) splitting
+    // [expected_min, expected_max] into equal ranges. Keys outside the range
+    // still work, they go to the first or last shard.
+    explicit ShardedTree(size_t shard_count = 0, int expected_min = INT_MIN, int expected_max = INT_MAX);
+
+    // Returns true if no shard holds a value.
+    bool isEmpty() const;
+
+    // Returns the total number of values.
+    size_t size() const;
+
+    // Returns the number of shards.
+    size_t shardCount() const;
+
+    // Inserts a value into the shard owning its range.
+    void insert(int value);
+
+    // Inserts many values at once, one pinned worker thread per shard.
+    void bulkInsert(const std::vector<int>& values);
+
+    // Returns true if the value exists. Counts toward the shard load like a write, so it
+    // may run the hot shard check (the values stay the same, only the shard bounds move).
+    bool search(int value) const;
+
+    // Removes a value. Throws std::runtime_error if the value is not found.
+    void remove(int value);
+
+    // Returns the minimum / maximum value. Throws std::runtime_error if empty.
+    int getMinValue() const;
+    int getMaxValue() const;
+
+    // Appends every value in ascending order to out.
+    void appendInOrder(std::vector<int>& out) const;
+
+    // Prints the values in ascending order.
+    void printInOrder() const;
+
+    // Configures automatic rebalancing: every interval operations (reads included), a
+    // shard that received more than factor times the mean load is split at its median
+    // and the coldest neighbouring pair is merged, keeping the shard count (at most one
+    // extra shard stays while every pair is next to the hot one). interval 0 disables
+    // rebalancing.
+    void setRebalancing(unsigned long long interval, double factor);
+
+    // Runs the hot shard check now. Returns true if the shard bounds changed.
+    bool rebalance();
+
+    // Prints the bounds, size and load of every shard.
+    void printStats(std::ostream& os = std::cout) const;
+
+    // Prints the values using the in-order traversal.
+    friend std::ostream& operator<<(std::ostream& os, const ShardedTree& sharded);
+};
+
+#endif // SHARDED_TREE_H
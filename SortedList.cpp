@@ -4,37 +4,147 @@ Author: Adar Shapira, ID: 209580208
         Almog Talker, ID: 322546680
 *****************************************/
 #include "SortedList.h"
+#include "BloomFilter.h"
+#include "FrozenSortedList.h"
+#include "OperationLog.h"
+#include "LoserTree.h"
+#include "SetAlgebra.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <stdexcept>
 #include <iostream>
+#include <thread>
 
 // This constructor is used internally to create data nodes
-SortedList::SortedList(int val) : data(val), next(nullptr), is_empty_head_flag(false) {}
+SortedList::Node::Node(int val) : data(val), deleted(false), next(nullptr), prev(nullptr) {}
+
+// Frees batches of purged nodes on its own thread, so a purge only has to unlink them.
+// The list never touches a node after handing it over, so nothing else is shared.
+struct SortedList::Reclaimer {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Node*> pending;
+    bool stopping;
+    std::thread worker; // last, so it starts after the fields it uses
+
+    Reclaimer() : stopping(false), worker(&Reclaimer::run, this) {}
+
+    // Frees whatever is still pending before returning
+    ~Reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    // Takes over the nodes of batch, leaving it empty
+    void hand(std::vector<Node*>& batch) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.insert(pending.end(), batch.begin(), batch.end());
+        }
+        batch.clear();
+        wake.notify_one();
+    }
+
+    void run() {
+        std::vector<Node*> batch;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !pending.empty(); });
+                if (pending.empty()) {
+                    return;
+                }
+                batch.swap(pending);
+            }
+            for (size_t i = 0; i < batch.size(); i++) {
+                delete batch[i];
+            }
+            batch.clear();
+        }
+    }
+};
+
+// A position in one input of mergeAll: the live nodes from node up to node_end, or the
+// inline values from value up to value_end.
+struct SortedList::MergeCursor {
+    const Node* node;
+    const Node* node_end;
+    const int* value;
+    const int* value_end;
+
+    bool atEnd() const {
+        return node == node_end && value == value_end;
+    }
+    int key() const {
+        return node != node_end ? node->data : *value;
+    }
+};
+
+// Merges smaller than this run on the calling thread
+static const size_t kParallelMergeThreshold = 1 << 16;
+
+// Every kMergeSampleStride-th node of an input is sampled to pick the slice pivots
+static const size_t kMergeSampleStride = 64;
+
+// Calls task(i) for every i in [0, n), spreading the calls over threads threads
+template <typename Task>
+static void runParallel(size_t n, unsigned threads, Task task) {
+    std::vector<std::thread> workers;
+    for (unsigned w = 1; w < threads; w++) {
+        workers.push_back(std::thread([&, w] {
+            for (size_t i = w; i < n; i += threads) {
+                task(i);
+            }
+        }));
+    }
+    for (size_t i = 0; i < n; i += threads) {
+        task(i);
+    }
+    for (size_t w = 0; w < workers.size(); w++) {
+        workers[w].join();
+    }
+}
 
 // --- Private Helper Functions ---
 
 // Helper for recursive insertion
 // Returns the head of the subtree after insertion
-SortedList* SortedList::_insert_node(SortedList* current_node, int value) {
+SortedList::Node* SortedList::_insert_node(Node* current_node, int value) {
     if (current_node == nullptr || value < current_node->data) {
-        SortedList* new_node = new SortedList(value);
+        Node* new_node = new Node(value);
         new_node->next = current_node;
+        if (current_node != nullptr) {
+            current_node->prev = new_node;
+        } else {
+            tail = new_node;
+        }
         return new_node;
     }
     // move to the next node to find insertion point.
     current_node->next = _insert_node(current_node->next, value);
+    current_node->next->prev = current_node;
     return current_node;
 }
 
 // Helper for recursive removal
 // Returns the head of the subtree after removal
-SortedList* SortedList::_remove_node(SortedList* current_node, int value, bool& removed_flag) {
+SortedList::Node* SortedList::_remove_node(Node* current_node, int value, bool& removed_flag) {
     if (current_node == nullptr) {
         removed_flag = false;
         return nullptr;
     }
     if (value == current_node->data) {
-        SortedList* temp = current_node->next;
-        current_node->next = nullptr; 
+        Node* temp = current_node->next;
+        if (temp != nullptr) {
+            temp->prev = current_node->prev;
+        } else {
+            tail = current_node->prev;
+        }
         delete current_node;
         removed_flag = true;
         return temp;
@@ -49,11 +159,11 @@ SortedList* SortedList::_remove_node(SortedList* current_node, int value, bool&
 
 // Helper for recursive search
 // Returns true if the value is found in the subtree, false otherwise
-bool SortedList::_search_node(const SortedList* current_node, int value) const {
+bool SortedList::_search_node(const Node* current_node, int value) const {
     if (current_node == nullptr) {
         return false;
     }
-    if (current_node->data == value) {
+    if (current_node->data == value && !current_node->deleted) {
         return true;
     }
     if (value < current_node->data) {
@@ -64,41 +174,48 @@ bool SortedList::_search_node(const SortedList* current_node, int value) const {
 
 // Helper for recursive print
 // Prints the elements of the subtree
-void SortedList::_print_nodes(const SortedList* current_node) const {
+void SortedList::_print_nodes(const Node* current_node, std::ostream& os) const {
     if (current_node == nullptr) {
         return;
     }
-    std::cout << current_node->data;
-    if (current_node->next != nullptr) {
-        std::cout << ", ";
+    // The tail is never a tombstone, so a live node before it always has a live successor
+    if (!current_node->deleted) {
+        os << current_node->data;
+        if (current_node->next != nullptr) {
+            os << ", ";
+        }
     }
-    _print_nodes(current_node->next);
+    _print_nodes(current_node->next, os);
 }
 
 // Helper for deep copying a subtree
 // Creates a new subtree that is a deep copy of the given other node
-SortedList* SortedList::_copy_nodes(const SortedList* otherNode) const {
+SortedList::Node* SortedList::_copy_nodes(const Node* otherNode) const {
+    // Tombstones are not copied
+    otherNode = _first_live(otherNode);
     if (otherNode == nullptr) {
         return nullptr;
     }
-    SortedList* new_node = new SortedList(otherNode->data);
+    Node* new_node = new Node(otherNode->data);
     new_node->next = _copy_nodes(otherNode->next);
+    if (new_node->next != nullptr) {
+        new_node->next->prev = new_node;
+    }
     return new_node;
 }
 
 // Helper for deep destruction of a subtree
 // Deletes all nodes in the given subtree
-void SortedList::_destroy_nodes(SortedList* current_node) {
+void SortedList::_destroy_nodes(Node* current_node) {
     while (current_node != nullptr) {
-        SortedList* next_node = current_node->next;
-        current_node->next = nullptr;
+        Node* next_node = current_node->next;
         delete current_node;
         current_node = next_node;
     }
 }
 
 // Helper to get the last node of a list
-SortedList* SortedList::_getLastNode(SortedList* current_node) {
+SortedList::Node* SortedList::_getLastNode(Node* current_node) {
     if (current_node == nullptr || current_node->next == nullptr) {
         return current_node;
     }
@@ -106,7 +223,9 @@ SortedList* SortedList::_getLastNode(SortedList* current_node) {
 }
 
 // Helper to check for equality recursively.
-bool SortedList::_are_equal_nodes(const SortedList* list1, const SortedList* list2) const {
+bool SortedList::_are_equal_nodes(const Node* list1, const Node* list2) const {
+    list1 = _first_live(list1);
+    list2 = _first_live(list2);
     if (list1 == nullptr && list2 == nullptr) {
         return true;
     }
@@ -116,115 +235,707 @@ bool SortedList::_are_equal_nodes(const SortedList* list1, const SortedList* lis
     return _are_equal_nodes(list1->next, list2->next);
 }
 
+// Helper for the set operations
+// Walks both lists together and appends every kept value once at the tail of the result.
+// Lists have no random access, so unlike BinaryTree there is no galloping: the walk is O(n + m).
+SortedList SortedList::_setOperation(const SortedList& other, SetOperation op) const {
+    if (head == nullptr || other.head == nullptr) {
+        // An inline list has at most a few dozen values, flattening both is cheap
+        std::vector<int> mine;
+        std::vector<int> theirs;
+        std::vector<int> merged;
+        appendInOrder(mine);
+        other.appendInOrder(theirs);
+        sortedSetOperation(op, mine.data(), mine.size(), theirs.data(), theirs.size(), merged);
+        return fromSorted(merged);
+    }
+    SortedList result;
+    const Node* first = _first_live(head);
+    const Node* second = _first_live(other.head);
+    while (first != nullptr || second != nullptr) {
+        int value;
+        bool keep;
+        bool in_first = second == nullptr || (first != nullptr && first->data <= second->data);
+        bool in_second = first == nullptr || (second != nullptr && second->data <= first->data);
+        if (in_first && in_second) {
+            value = first->data;
+            keep = keepsBoth(op);
+        }
+        else if (in_first) {
+            value = first->data;
+            keep = keepsOnlyFirst(op);
+        }
+        else {
+            value = second->data;
+            keep = keepsOnlySecond(op);
+        }
+        // Skip every copy of the value in both lists
+        while (first != nullptr && first->data == value) {
+            first = _first_live(first->next);
+        }
+        while (second != nullptr && second->data == value) {
+            second = _first_live(second->next);
+        }
+        if (keep) {
+            result._link_after(result.tail, new Node(value));
+            result.count++;
+        }
+    }
+    return result;
+}
+
+// Helper to link new_node right after position (nullptr: at the front)
+void SortedList::_link_after(Node* position, Node* new_node) {
+    new_node->prev = position;
+    new_node->next = position != nullptr ? position->next : head;
+    if (new_node->next != nullptr) {
+        new_node->next->prev = new_node;
+    } else {
+        tail = new_node;
+    }
+    if (position != nullptr) {
+        position->next = new_node;
+    } else {
+        head = new_node;
+    }
+}
+
+// Helper to unlink a node without deleting it
+void SortedList::_unlink_node(Node* node) {
+    if (node->prev != nullptr) {
+        node->prev->next = node->next;
+    } else {
+        head = node->next;
+    }
+    if (node->next != nullptr) {
+        node->next->prev = node->prev;
+    } else {
+        tail = node->prev;
+    }
+    node->next = nullptr;
+    node->prev = nullptr;
+}
+
+// Helper to skip tombstones
+const SortedList::Node* SortedList::_first_live(const Node* node) {
+    while (node != nullptr && node->deleted) {
+        node = node->next;
+    }
+    return node;
+}
+
+// Helper to mark a value deleted without unlinking it
+bool SortedList::_mark_deleted(int value) {
+    Node* node = head;
+    while (node != nullptr && (node->data < value || (node->data == value && node->deleted))) {
+        node = node->next;
+    }
+    if (node == nullptr || node->data != value) {
+        return false;
+    }
+    node->deleted = true;
+    tombstones++;
+    return true;
+}
+
+// Helper to free the tombstones exposed at either end by a pop
+void SortedList::_trim_tombstones() {
+    while (head != nullptr && head->deleted) {
+        Node* node = head;
+        _unlink_node(node);
+        delete node;
+        tombstones--;
+    }
+    while (tail != nullptr && tail->deleted) {
+        Node* node = tail;
+        _unlink_node(node);
+        delete node;
+        tombstones--;
+    }
+}
+
+// Helper for mergeAll, a cursor over every value of the list
+SortedList::MergeCursor SortedList::_cursor() const {
+    MergeCursor cursor;
+    cursor.node = _first_live(head);
+    cursor.node_end = nullptr;
+    cursor.value = small_values.begin();
+    cursor.value_end = small_values.end();
+    return cursor;
+}
+
+// Helper for mergeAll
+// Appends the values under every cursor to the tail of out in ascending order. With relink
+// the nodes themselves are moved into out, which is only allowed when the caller owns the inputs.
+void SortedList::_merge_cursors(std::vector<MergeCursor>& cursors, SortedList& out, bool relink) {
+    LoserTree tree(cursors.size());
+    for (size_t i = 0; i < cursors.size(); i++) {
+        if (!cursors[i].atEnd()) {
+            tree.set(i, cursors[i].key());
+        }
+    }
+    tree.build();
+    while (!tree.empty()) {
+        MergeCursor& cursor = cursors[tree.winner()];
+        if (cursor.node != cursor.node_end) {
+            const Node* node = cursor.node;
+            cursor.node = _first_live(node->next);
+            if (relink) {
+                out._link_after(out.tail, const_cast<Node*>(node));
+            } else {
+                out._link_after(out.tail, new Node(node->data));
+            }
+        }
+        else {
+            out._link_after(out.tail, new Node(*cursor.value));
+            cursor.value++;
+        }
+        out.count++;
+        if (cursor.atEnd()) {
+            tree.exhaustWinner();
+        } else {
+            tree.replaceWinner(cursor.key());
+        }
+    }
+}
+
+// Helper for mergeAll
+// A parallel merge samples every input to pick pivots that split the values evenly, cuts
+// every input at the pivots (all copies of a key land in one slice), merges the slices on
+// separate threads and splices the resulting chains in key order.
+SortedList SortedList::_merge_all(const std::vector<SortedList>& lists, unsigned threads, bool relink) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < lists.size(); i++) {
+        total += lists[i].count;
+    }
+
+    // Sample the node lists, keeping the sampled nodes as starting points for the cuts
+    std::vector<std::vector<const Node*> > checkpoints(lists.size());
+    std::vector<int> pivots;
+    if (threads > 1 && total >= kParallelMergeThreshold) {
+        runParallel(lists.size(), threads, [&](size_t i) {
+            size_t position = 0;
+            for (const Node* node = _first_live(lists[i].head); node != nullptr; node = _first_live(node->next)) {
+                if (position++ % kMergeSampleStride == 0) {
+                    checkpoints[i].push_back(node);
+                }
+            }
+        });
+        std::vector<int> sample;
+        for (size_t i = 0; i < lists.size(); i++) {
+            for (size_t c = 0; c < checkpoints[i].size(); c++) {
+                sample.push_back(checkpoints[i][c]->data);
+            }
+        }
+        std::sort(sample.begin(), sample.end());
+        for (unsigned t = 1; t < threads && !sample.empty(); t++) {
+            int pivot = sample[sample.size() * t / threads];
+            if (pivots.empty() || pivot > pivots.back()) {
+                pivots.push_back(pivot);
+            }
+        }
+    }
+
+    SortedList result;
+    if (pivots.empty()) {
+        std::vector<MergeCursor> cursors;
+        for (size_t i = 0; i < lists.size(); i++) {
+            cursors.push_back(lists[i]._cursor());
+        }
+        _merge_cursors(cursors, result, relink);
+    }
+    else {
+        // Cut every input at the pivots: slices[s][i] covers the keys of list i in slice s
+        size_t slice_count = pivots.size() + 1;
+        std::vector<std::vector<MergeCursor> > slices(slice_count, std::vector<MergeCursor>(lists.size()));
+        runParallel(lists.size(), threads, [&](size_t i) {
+            const SortedList& list = lists[i];
+            MergeCursor whole = list._cursor();
+            const std::vector<const Node*>& marks = checkpoints[i];
+            for (size_t s = 0; s < slice_count; s++) {
+                MergeCursor& slice = slices[s][i];
+                slice = whole;
+                if (s + 1 == slice_count) {
+                    break;
+                }
+                int pivot = pivots[s];
+                // Start from the last checkpoint below the pivot
+                size_t mark = std::lower_bound(marks.begin(), marks.end(), pivot,
+                                               [](const Node* node, int key) { return node->data < key; }) -
+                              marks.begin();
+                const Node* node = mark > 0 ? marks[mark - 1] : whole.node;
+                while (node != nullptr && node->data < pivot) {
+                    node = _first_live(node->next);
+                }
+                const int* value = std::lower_bound(whole.value, whole.value_end, pivot);
+                slice.node_end = node;
+                slice.value_end = value;
+                whole.node = node;
+                whole.value = value;
+            }
+        });
+
+        std::vector<SortedList> parts(slice_count);
+        runParallel(slice_count, threads, [&](size_t s) { _merge_cursors(slices[s], parts[s], relink); });
+        for (size_t s = 0; s < slice_count; s++) {
+            SortedList& part = parts[s];
+            if (part.head == nullptr) {
+                continue;
+            }
+            if (result.tail == nullptr) {
+                result.head = part.head;
+            } else {
+                result.tail->next = part.head;
+                part.head->prev = result.tail;
+            }
+            result.tail = part.tail;
+            result.count += part.count;
+            part.head = nullptr;
+            part.tail = nullptr;
+            part.count = 0;
+        }
+    }
+
+    // Same storage as fromSorted for the same values
+    if (result.head != nullptr && result.count <= InlineSortedArray::kCapacity) {
+        result._demote();
+    }
+    return result;
+}
+
+// Helper to move the inline values into linked nodes
+void SortedList::_promote() {
+    for (const int* value = small_values.begin(); value != small_values.end(); value++) {
+        _link_after(tail, new Node(*value));
+    }
+    small_values.clear();
+}
+
+// Helper to move the values of a short node list back into the inline array
+void SortedList::_demote() {
+    for (const Node* node = _first_live(head); node != nullptr; node = _first_live(node->next)) {
+        small_values.pushBack(node->data);
+    }
+    _destroy_nodes(head);
+    head = nullptr;
+    tail = nullptr;
+    tombstones = 0;
+}
+
+// Helper for the bookkeeping of a single insert
+void SortedList::_after_insert(int value) {
+    count++;
+    if (filter != nullptr) {
+        if (filter->needsResize()) {
+            // Rebuild with room to grow so the false positive rate stays low
+            enableFilter(2 * count);
+        } else {
+            filter->insert(value);
+        }
+    }
+    if (log != nullptr) {
+        log->logInsert(value);
+    }
+}
+
+// Helper for the bookkeeping of a single remove
+void SortedList::_after_remove(int value) {
+    count--;
+    if (filter != nullptr) {
+        filter->remove(value);
+    }
+    if (log != nullptr) {
+        log->logRemove(value);
+    }
+    if (head != nullptr && count <= kDemoteSize) {
+        _demote();
+    }
+}
+
 
 // --- Public Member Functions ---
 
 // Default Constructor, initializes the list to an empty state
-SortedList::SortedList() : data(0), next(nullptr), is_empty_head_flag(true) {}
+SortedList::SortedList()
+    : head(nullptr), tail(nullptr), count(0), capacity(0), keep_policy(KeepPolicy::Largest), rejected(0),
+      filter(nullptr), log(nullptr), lazy_delete(false), purge_ratio(0.25), tombstones(0), purges(0),
+      reclaimer(nullptr) {}
+
+// Creates a list holding a single value
+SortedList::SortedList(int val)
+    : head(nullptr), tail(nullptr), count(1), capacity(0), keep_policy(KeepPolicy::Largest), rejected(0),
+      filter(nullptr), log(nullptr), lazy_delete(false), purge_ratio(0.25), tombstones(0), purges(0),
+      reclaimer(nullptr) {
+    small_values.pushBack(val);
+}
 
 // Destructor, cleans up all dynamic memory in the list
 SortedList::~SortedList() {
-    // Only destroy nodes if this object is not an empty head or if it has children
-    if (!is_empty_head_flag) { 
-        _destroy_nodes(this->next);
-    }
-    this->next = nullptr;
+    _destroy_nodes(head);
+    head = nullptr;
+    delete filter;
+    delete reclaimer;
 }
 
 // Copy Constructor (Deep Copy), creates a new SortedList object that is a deep copy of other
-SortedList::SortedList(const SortedList& other) : data(0), next(nullptr), is_empty_head_flag(true) {
-    if (!other.isEmpty()) {
-        this->data = other.data;
-        this->next = _copy_nodes(other.next);
-        this->is_empty_head_flag = false;
+SortedList::SortedList(const SortedList& other)
+    : head(nullptr), tail(nullptr), count(0), capacity(other.capacity), keep_policy(other.keep_policy), rejected(0),
+      filter(nullptr), log(nullptr), lazy_delete(other.lazy_delete), purge_ratio(other.purge_ratio), tombstones(0),
+      purges(0), reclaimer(other.reclaimer != nullptr ? new Reclaimer() : nullptr) {
+    small_values = other.small_values;
+    head = _copy_nodes(other.head);
+    tail = _getLastNode(head);
+    count = other.count;
+    if (other.filter != nullptr) {
+        filter = new CountingBloomFilter(*other.filter);
     }
 }
 
 // Assigns content to the current SortedList object
+// An attached log keeps logging this list; other's values are written to it as a snapshot first
 SortedList& SortedList::operator=(const SortedList& other) {
     if (this == &other) {
         return *this;
     }
+    if (log != nullptr) {
+        log->compact(other);
+    }
 
     // Deallocate existing resources of the current list
-    if (!is_empty_head_flag) {
-        _destroy_nodes(this->next);
-    }
-    this->next = nullptr;
+    _destroy_nodes(head);
+    head = nullptr;
+    delete filter;
+    filter = nullptr;
 
     // Copy data from other
-    if (other.isEmpty()) {
-        this->is_empty_head_flag = true;
-        this->data = 0; // Default uninitialized value
-    } else {
-        this->is_empty_head_flag = false;
-        this->data = other.data;
-        this->next = _copy_nodes(other.next);
+    small_values = other.small_values;
+    head = _copy_nodes(other.head);
+    tail = _getLastNode(head);
+    count = other.count;
+    capacity = other.capacity;
+    keep_policy = other.keep_policy;
+    tombstones = 0;
+    if (other.reclaimer != nullptr) {
+        enableLazyDelete(other.purge_ratio, true);
+    }
+    else if (other.lazy_delete) {
+        enableLazyDelete(other.purge_ratio, false);
+    }
+    else {
+        disableLazyDelete();
+    }
+    if (other.filter != nullptr) {
+        filter = new CountingBloomFilter(*other.filter);
     }
     return *this;
 }
 
+// Move Constructor, takes over the nodes and filter of other
+SortedList::SortedList(SortedList&& other) noexcept
+    : small_values(other.small_values), head(other.head), tail(other.tail), count(other.count),
+      capacity(other.capacity), keep_policy(other.keep_policy), rejected(other.rejected), filter(other.filter),
+      log(other.log), lazy_delete(other.lazy_delete), purge_ratio(other.purge_ratio), tombstones(other.tombstones),
+      purges(other.purges), reclaimer(other.reclaimer) {
+    other.small_values.clear();
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.count = 0;
+    other.filter = nullptr;
+    other.log = nullptr;
+    other.tombstones = 0;
+    other.reclaimer = nullptr;
+}
+
+// Move Assignment, frees the current nodes and takes over those of other
+// An attached log is kept and gets other's values as a snapshot; otherwise other's log comes along
+SortedList& SortedList::operator=(SortedList&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (log != nullptr) {
+        log->compact(other);
+    }
+    else {
+        log = other.log;
+    }
+    _destroy_nodes(head);
+    delete filter;
+    delete reclaimer;
+    small_values = other.small_values;
+    other.small_values.clear();
+    head = other.head;
+    tail = other.tail;
+    count = other.count;
+    capacity = other.capacity;
+    keep_policy = other.keep_policy;
+    rejected = other.rejected;
+    filter = other.filter;
+    lazy_delete = other.lazy_delete;
+    purge_ratio = other.purge_ratio;
+    tombstones = other.tombstones;
+    purges = other.purges;
+    reclaimer = other.reclaimer;
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.count = 0;
+    other.filter = nullptr;
+    other.log = nullptr;
+    other.tombstones = 0;
+    other.reclaimer = nullptr;
+    return *this;
+}
+
+// Build a list from sorted values, appending every node at the tail
+SortedList SortedList::fromSorted(const std::vector<int>& values) {
+    SortedList result;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values.size() <= InlineSortedArray::kCapacity) {
+            result.small_values.pushBack(values[i]);
+        } else {
+            result._link_after(result.tail, new Node(values[i]));
+        }
+    }
+    result.count = values.size();
+    return result;
+}
+
+// Replace the values, keeping the settings of the list
+void SortedList::assignSorted(const std::vector<int>& values) {
+    SortedList built = fromSorted(values);
+    if (log != nullptr) {
+        log->compact(values);
+    }
+    _destroy_nodes(head);
+    small_values = built.small_values;
+    head = built.head;
+    tail = built.tail;
+    count = built.count;
+    tombstones = 0;
+    built.head = nullptr;
+    built.tail = nullptr;
+    built.count = 0;
+    if (filter != nullptr) {
+        enableFilter();
+    }
+    setCapacity(capacity, keep_policy);
+}
+
+// Merge many lists, copying their values
+SortedList SortedList::mergeAll(const std::vector<SortedList>& lists, unsigned threads) {
+    return _merge_all(lists, threads, false);
+}
+
+// Merge many lists, moving their nodes into the result
+SortedList SortedList::mergeAll(std::vector<SortedList>&& lists, unsigned threads) {
+    for (size_t i = 0; i < lists.size(); i++) {
+        lists[i].purge();
+    }
+    SortedList result = _merge_all(lists, threads, true);
+    // The nodes now belong to result, only the emptied lists are left to free
+    for (size_t i = 0; i < lists.size(); i++) {
+        lists[i].head = nullptr;
+        lists[i].tail = nullptr;
+        lists[i].count = 0;
+    }
+    lists.clear();
+    return result;
+}
+
 // Check if the list is empty
 bool SortedList::isEmpty() const {
-    return is_empty_head_flag;
+    return count == 0;
+}
+
+// Number of values in the list
+size_t SortedList::size() const {
+    return count;
 }
 
 // Inserts a value into the list
 void SortedList::insert(int value) {
-    if (isEmpty()) {
-        data = value;
-        is_empty_head_flag = false; // List is no longer empty
+    offer(value);
+}
+
+// Inserts a value unless a full bounded list would evict it right away
+bool SortedList::offer(int value) {
+    if (capacity > 0 && count >= capacity) {
+        bool misses_cut = keep_policy == KeepPolicy::Largest ? value <= getFirst() : value >= getLast();
+        if (misses_cut) {
+            rejected++;
+            return false;
+        }
     }
-    else {
-        if (value < this->data) {
-            int old_data = this->data;
-            SortedList* old_next = this->next;
 
-            this->data = value; 
-            this->next = new SortedList(old_data);
-            this->next->next = old_next;
+    if (head == nullptr && small_values.full()) {
+        _promote();
+    }
+    if (head == nullptr) {
+        small_values.insert(value);
+    }
+    else if (value < head->data) {
+        _link_after(nullptr, new Node(value));
+    }
+    else if (value >= tail->data) {
+        _link_after(tail, new Node(value));
+    }
+    else if (static_cast<long long>(value) - head->data <= static_cast<long long>(tail->data) - value) {
+        head = _insert_node(head, value);
+    }
+    else {
+        // Closer to the back: walk back to the last value not above the new one
+        Node* position = tail;
+        while (position->data > value) {
+            position = position->prev;
         }
-        else {
-            this->next = _insert_node(this->next, value);
+        _link_after(position, new Node(value));
+    }
+    _after_insert(value);
+
+    if (capacity > 0 && count > capacity) {
+        if (keep_policy == KeepPolicy::Largest) {
+            popFirst();
+        } else {
+            popLast();
         }
     }
+    return true;
 }
 
 // Removes a value from the list
 bool SortedList::remove(int value) {
     bool removedFlag = false;
-    if (!isEmpty() && data == value) {
-        if (next == nullptr) {
-            is_empty_head_flag = true;
-            data = 0;
+    if (head == nullptr) {
+        if (!small_values.removeOne(value)) {
+            return false;
         }
-        else {
-            SortedList* old_next_node = next;
-            data = old_next_node->data;
-            next = old_next_node->next;
-            old_next_node->next = nullptr;
-            delete old_next_node;
+        _after_remove(value);
+        return true;
+    }
+    if (value < head->data || value > tail->data) {
+        return false;
+    }
+    // Either end is removed in O(1)
+    if (value == head->data) {
+        popFirst();
+        return true;
+    }
+    if (value == tail->data) {
+        popLast();
+        return true;
+    }
+    // A value the filter rejects cannot be in the list
+    if (filter != nullptr && !filter->mayContain(value)) {
+        return false;
+    }
+    if (lazy_delete) {
+        if (!_mark_deleted(value)) {
+            if (filter != nullptr) {
+                filter->recordFalsePositive();
+            }
+            return false;
+        }
+        _after_remove(value);
+        if (head != nullptr && tombstones >= kMinPurge && tombstones > purge_ratio * (count + tombstones)) {
+            purge();
         }
-        removedFlag = true;
         return true;
     }
-    // Search and remove from the rest of the list
-    this->next = _remove_node(this->next, value, removedFlag);
+    head = _remove_node(head, value, removedFlag);
+    if (removedFlag) {
+        _after_remove(value);
+    }
+    else if (filter != nullptr) {
+        filter->recordFalsePositive();
+    }
     return removedFlag;
 }
 
+// Removes the first item
+int SortedList::popFirst() {
+    if (isEmpty()) {
+        throw std::out_of_range("Attempted to pop from an empty list.");
+    }
+    if (head == nullptr) {
+        int value = small_values.front();
+        small_values.removeAt(0);
+        _after_remove(value);
+        return value;
+    }
+    Node* node = head;
+    int value = node->data;
+    _unlink_node(node);
+    delete node;
+    if (tombstones > 0) {
+        _trim_tombstones();
+    }
+    _after_remove(value);
+    return value;
+}
+
+// Removes the last item
+int SortedList::popLast() {
+    if (isEmpty()) {
+        throw std::out_of_range("Attempted to pop from an empty list.");
+    }
+    if (head == nullptr) {
+        int value = small_values.back();
+        small_values.removeAt(small_values.size() - 1);
+        _after_remove(value);
+        return value;
+    }
+    Node* node = tail;
+    int value = node->data;
+    _unlink_node(node);
+    delete node;
+    if (tombstones > 0) {
+        _trim_tombstones();
+    }
+    _after_remove(value);
+    return value;
+}
+
+// Bound the list, evicting from the end the policy gives up
+void SortedList::setCapacity(size_t new_capacity, KeepPolicy keep) {
+    capacity = new_capacity;
+    keep_policy = keep;
+    while (capacity > 0 && count > capacity) {
+        if (keep_policy == KeepPolicy::Largest) {
+            popFirst();
+        } else {
+            popLast();
+        }
+    }
+}
+
+size_t SortedList::getCapacity() const {
+    return capacity;
+}
+
 // Search for a value in the list
 bool SortedList::search(int value) const {
-    if (isEmpty()) {
+    if (head == nullptr) {
+        return small_values.contains(value);
+    }
+    if (head->data == value) {
+        return true;
+    }
+    if (value < head->data || value > tail->data) {
         return false;
     }
-    if (data == value) {
+    if (value == tail->data) {
         return true;
     }
-    if (value < data) {
+    if (filter != nullptr && !filter->mayContain(value)) {
         return false;
     }
-    return _search_node(this->next, value);
+    bool found = _search_node(head->next, value);
+    if (!found && filter != nullptr) {
+        filter->recordFalsePositive();
+    }
+    return found;
 }
 
 // Print list elements
@@ -233,10 +944,35 @@ void SortedList::printList() const {
         std::cout << "List is empty.";
         return;
     }
-    std::cout << data;
-    if (next != nullptr) {
-        std::cout << " ";
-        _print_nodes(this->next);
+    std::cout << *this;
+}
+
+// Append the values in ascending order
+void SortedList::appendInOrder(std::vector<int>& out) const {
+    out.insert(out.end(), small_values.begin(), small_values.end());
+    for (const Node* node = _first_live(head); node != nullptr; node = _first_live(node->next)) {
+        out.push_back(node->data);
+    }
+}
+
+// Append the values in [low, high] in ascending order
+void SortedList::appendRange(int low, int high, std::vector<int>& out, size_t limit) const {
+    if (head == nullptr) {
+        for (size_t i = small_values.lowerBound(low); i < small_values.size() && limit > 0; i++, limit--) {
+            if (small_values[i] > high) {
+                break;
+            }
+            out.push_back(small_values[i]);
+        }
+        return;
+    }
+    const Node* node = _first_live(head);
+    while (node != nullptr && node->data < low) {
+        node = _first_live(node->next);
+    }
+    for (size_t added = 0; node != nullptr && node->data <= high && added < limit; added++) {
+        out.push_back(node->data);
+        node = _first_live(node->next);
     }
 }
 
@@ -245,36 +981,190 @@ int SortedList::getFirst() const {
     if (isEmpty()) {
         throw std::out_of_range("Attempted to get first element from an empty list.");
     }
-    return data;
+    return head != nullptr ? head->data : small_values.front();
 }
 
+// Get the last item
+int SortedList::getLast() const {
+    if (isEmpty()) {
+        throw std::out_of_range("Attempted to get last element from an empty list.");
+    }
+    return tail != nullptr ? tail->data : small_values.back();
+}
 
-// --- Operators ---
+// Attach (or rebuild) the membership filter
+void SortedList::enableFilter(size_t expected_keys) {
+    CountingBloomFilter* rebuilt = new CountingBloomFilter(expected_keys > 0 ? expected_keys : count);
+    for (const int* value = small_values.begin(); value != small_values.end(); value++) {
+        rebuilt->insert(*value);
+    }
+    for (const Node* node = _first_live(head); node != nullptr; node = _first_live(node->next)) {
+        rebuilt->insert(node->data);
+    }
+    delete filter;
+    filter = rebuilt;
+}
 
-// Concatenate 'SortedList' objects
-SortedList SortedList::operator+(const SortedList& other) const {
-    SortedList result_list;
+// Detach the membership filter
+void SortedList::disableFilter() {
+    delete filter;
+    filter = nullptr;
+}
 
-    // Insert elements from the current list
-    const SortedList* current_this = this;
-    if (!current_this->isEmpty()) {
-        result_list.insert(current_this->data);
-        const SortedList* temp_node = current_this->next;
-        while (temp_node != nullptr) {
-            result_list.insert(temp_node->data);
-            temp_node = temp_node->next;
-        }
+// Check if a membership filter is attached
+bool SortedList::hasFilter() const {
+    return filter != nullptr;
+}
+
+// Switch remove to tombstones
+void SortedList::enableLazyDelete(double ratio, bool background_reclaim) {
+    if (!(ratio > 0 && ratio <= 1)) {
+        throw std::invalid_argument("Purge ratio must be in (0, 1].");
+    }
+    lazy_delete = true;
+    purge_ratio = ratio;
+    if (background_reclaim && reclaimer == nullptr) {
+        reclaimer = new Reclaimer();
     }
+    else if (!background_reclaim && reclaimer != nullptr) {
+        delete reclaimer;
+        reclaimer = nullptr;
+    }
+}
+
+// Switch remove back to unlinking
+void SortedList::disableLazyDelete() {
+    purge();
+    lazy_delete = false;
+    delete reclaimer;
+    reclaimer = nullptr;
+}
 
-    const SortedList* current_other = &other;
-    if (!current_other->isEmpty()) {
-        const SortedList* temp_other = &other;
-        while (temp_other != nullptr && !temp_other->isEmpty()) {
-            result_list.insert(temp_other->data);
-            temp_other = temp_other->next;
+// Unlink every tombstone in one pass from head to tail
+size_t SortedList::purge() {
+    if (tombstones == 0) {
+        return 0;
+    }
+    std::vector<Node*> batch;
+    if (reclaimer != nullptr) {
+        batch.reserve(tombstones);
+    }
+    size_t unlinked = 0;
+    Node* node = head;
+    while (node != nullptr) {
+        Node* next = node->next;
+        if (node->deleted) {
+            _unlink_node(node);
+            if (reclaimer != nullptr) {
+                batch.push_back(node);
+            } else {
+                delete node;
+            }
+            unlinked++;
         }
+        node = next;
     }
-    return result_list;
+    tombstones = 0;
+    purges++;
+    if (!batch.empty()) {
+        reclaimer->hand(batch);
+    }
+    return unlinked;
+}
+
+size_t SortedList::tombstoneCount() const {
+    return tombstones;
+}
+
+// Attach the write-ahead log
+void SortedList::attachLog(OperationLog* target) {
+    log = target;
+}
+
+// Detach the write-ahead log
+void SortedList::detachLog() {
+    log = nullptr;
+}
+
+// Set algebra
+SortedList SortedList::unionWith(const SortedList& other) const {
+    return _setOperation(other, SetOperation::Union);
+}
+
+SortedList SortedList::intersect(const SortedList& other) const {
+    return _setOperation(other, SetOperation::Intersection);
+}
+
+SortedList SortedList::difference(const SortedList& other) const {
+    return _setOperation(other, SetOperation::Difference);
+}
+
+SortedList SortedList::symmetricDifference(const SortedList& other) const {
+    return _setOperation(other, SetOperation::SymmetricDifference);
+}
+
+// Pack the values into a frozen list, a block at a time
+FrozenSortedList SortedList::compact() const {
+    FrozenSortedList::Builder builder;
+    for (const int* value = small_values.begin(); value != small_values.end(); value++) {
+        builder.append(*value);
+    }
+    for (const Node* node = _first_live(head); node != nullptr; node = _first_live(node->next)) {
+        builder.append(node->data);
+    }
+    return builder.finish();
+}
+
+// Get the memory used
+size_t SortedList::memoryBytes() const {
+    size_t bytes = sizeof(*this);
+    if (head != nullptr) {
+        bytes += (count + tombstones) * sizeof(Node);
+    }
+    if (filter != nullptr) {
+        bytes += filter->memoryBytes();
+    }
+    return bytes;
+}
+
+// Print the list statistics
+void SortedList::printStats(std::ostream& os) const {
+    os << "SortedList: size=" << count;
+    if (head == nullptr) {
+        os << " storage=inline";
+    } else {
+        os << " storage=nodes node_bytes=" << (count + tombstones) * sizeof(Node);
+    }
+    if (capacity > 0) {
+        os << " capacity=" << capacity << " keep=" << (keep_policy == KeepPolicy::Largest ? "largest" : "smallest")
+           << " rejected=" << rejected;
+    }
+    if (lazy_delete) {
+        size_t linked = count + tombstones;
+        os << " tombstones=" << tombstones
+           << " tombstone_ratio=" << (linked > 0 ? static_cast<double>(tombstones) / linked : 0.0)
+           << " purges=" << purges << " reclaim=" << (reclaimer != nullptr ? "background" : "inline");
+    }
+    if (filter != nullptr) {
+        os << " ";
+        filter->printStats(os);
+    }
+    os << "\n";
+}
+
+
+// --- Operators ---
+
+// Concatenate 'SortedList' objects
+SortedList SortedList::operator+(const SortedList& other) const {
+    // Both lists are sorted, so a merge keeps every copy in order
+    std::vector<int> values;
+    std::vector<int> other_values;
+    appendInOrder(values);
+    other.appendInOrder(other_values);
+    std::vector<int> merged(values.size() + other_values.size());
+    std::merge(values.begin(), values.end(), other_values.begin(), other_values.end(), merged.begin());
+    return fromSorted(merged);
 }
 
 
@@ -303,10 +1193,17 @@ bool SortedList::operator==(const SortedList& other) const {
     if (this_is_empty && other_is_empty) {
         return true;
     }
-    if (this_is_empty || other_is_empty) {
+    if (this_is_empty || other_is_empty || count != other.count) {
         return false;
     }
-    return _are_equal_nodes(this, &other);
+    if (head == nullptr || other.head == nullptr) {
+        std::vector<int> values;
+        std::vector<int> other_values;
+        appendInOrder(values);
+        other.appendInOrder(other_values);
+        return values == other_values;
+    }
+    return _are_equal_nodes(head, other.head);
 }
 
 // Insert operator
@@ -314,8 +1211,18 @@ std::ostream& operator<<(std::ostream& os, const SortedList& list) {
     if (list.isEmpty()) {
         os << "List is empty.";
     }
+    else if (list.head == nullptr) {
+        os << list.small_values[0];
+        for (size_t i = 1; i < list.small_values.size(); i++) {
+            os << (i == 1 ? " " : ", ") << list.small_values[i];
+        }
+    }
     else {
-        list.printList();
+        os << list.head->data;
+        if (list.head->next != nullptr) {
+            os << " ";
+            list._print_nodes(list.head->next, os);
+        }
     }
     return os;
-}
\ No newline at end of file
+}
@@ -6,43 +6,127 @@ Author: Adar Shapira, ID: 209580208
 #ifndef SORTED_LIST_H
 #define SORTED_LIST_H
 
+#include "InlineSortedArray.h"
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 class SortedList;
+class CountingBloomFilter;
+class FrozenSortedList;
+class OperationLog;
+enum class SetOperation;
 
 // Forward declaration of operator<< for friend declaration
 std::ostream& operator<<(std::ostream& os, const SortedList& list);
 
 class SortedList {
+public:
+    // Which end of a bounded list survives when it overflows (see setCapacity).
+    enum class KeepPolicy {
+        Largest,   // keep the largest values, evict from the front
+        Smallest   // keep the smallest values, evict from the back
+    };
+
 private:
-    int data;
-    SortedList* next;
-    bool is_empty_head_flag;
+    // A single list node. Per-list state lives in SortedList itself so nodes stay small.
+    // Nodes are doubly linked so both ends can be popped in O(1).
+    // A removed value may stay linked as a tombstone (deleted == true) until the next purge.
+    struct Node {
+        int data;
+        bool deleted;
+        Node* next;
+        Node* prev;
+
+        Node(int val);
+    };
+
+    // Frees purged nodes on a background thread (see enableLazyDelete)
+    struct Reclaimer;
+
+    // A position in one input of mergeAll (defined in SortedList.cpp)
+    struct MergeCursor;
+
+    // A purge runs only once this many tombstones are linked, so tiny lists are not rescanned
+    static const size_t kMinPurge = 64;
+
+    // Small lists keep their values in small_values and have no nodes (head == nullptr).
+    // Inserting past the inline capacity moves the values into nodes; removing down to
+    // kDemoteSize moves them back, so a size oscillating around the capacity does not thrash.
+    static const size_t kDemoteSize = InlineSortedArray::kCapacity / 2;
+    InlineSortedArray small_values;
+
+    Node* head;
+    Node* tail;
+    size_t count;
+    size_t capacity;             // 0: unbounded
+    KeepPolicy keep_policy;
+    unsigned long long rejected; // offers turned away by a full bounded list
+    CountingBloomFilter* filter; // optional membership filter, nullptr when disabled
+    OperationLog* log;           // optional write-ahead log (not owned), nullptr when detached
+    bool lazy_delete;            // remove leaves tombstones instead of unlinking
+    double purge_ratio;          // purge once tombstones exceed this fraction of the nodes
+    size_t tombstones;           // removed values still linked
+    unsigned long long purges;
+    Reclaimer* reclaimer;        // nullptr: purged nodes are freed by the caller
 
     // Helper for recursive insertion
-    SortedList* _insert_node(SortedList* current_node, int value);
+    Node* _insert_node(Node* current_node, int value);
 
     // Helper for recursive removal
-    SortedList* _remove_node(SortedList* current_node, int value, bool& removed_flag);
+    Node* _remove_node(Node* current_node, int value, bool& removed_flag);
 
     // Helper for recursive search
-    bool _search_node(const SortedList* current_node, int value) const;
+    bool _search_node(const Node* current_node, int value) const;
 
     // Helper for recursive print
-    void _print_nodes(const SortedList* current_node) const;
+    void _print_nodes(const Node* current_node, std::ostream& os) const;
 
     // Helper for deep copy (used in copy constructor/assignment)
-    SortedList* _copy_nodes(const SortedList* other_node) const;
+    Node* _copy_nodes(const Node* other_node) const;
 
     // Helper for deep destruction
-    void _destroy_nodes(SortedList* current_node);
+    void _destroy_nodes(Node* current_node);
 
     // Helper to get the last node for concatenation for efficient appending
-    SortedList* _getLastNode(SortedList* current_node);
+    Node* _getLastNode(Node* current_node);
 
     // Private helper to check for equality recursively (for operator==)
-    bool _are_equal_nodes(const SortedList* list1, const SortedList* list2) const;
+    bool _are_equal_nodes(const Node* list1, const Node* list2) const;
+
+    // Helper for the set operations (walks both lists once)
+    SortedList _setOperation(const SortedList& other, SetOperation op) const;
+
+    // Helper to link new_node right after position (nullptr: at the front)
+    void _link_after(Node* position, Node* new_node);
+
+    // Helper to unlink a node without deleting it
+    void _unlink_node(Node* node);
+
+    // Helper to skip tombstones, returns the first live node from node on (or nullptr)
+    static const Node* _first_live(const Node* node);
+
+    // Helper to mark the first live copy of value deleted, returns false if there is none
+    bool _mark_deleted(int value);
+
+    // Helper to free the tombstones left at either end, so head and tail stay live
+    void _trim_tombstones();
+
+    // Helpers to move the values from the inline array into nodes and back
+    void _promote();
+    void _demote();
+
+    // Helpers for mergeAll: a cursor over the whole list, the loser tree merge of some
+    // cursors into out, and the (possibly parallel) driver
+    MergeCursor _cursor() const;
+    static void _merge_cursors(std::vector<MergeCursor>& cursors, SortedList& out, bool relink);
+    static SortedList _merge_all(const std::vector<SortedList>& lists, unsigned threads, bool relink);
+
+    // Helpers for the size, filter and log bookkeeping of a single insert / remove
+    void _after_insert(int value);
+    void _after_remove(int value);
 
 
 public:
@@ -56,26 +140,124 @@ public:
     SortedList(const SortedList& other);
     SortedList& operator=(const SortedList& other);
 
+    // Move Constructor and Assignment Operator (take over the nodes of other, leaving it empty)
+    SortedList(SortedList&& other) noexcept;
+    SortedList& operator=(SortedList&& other);
+
+    // Builds a list from values sorted in ascending order, linking the nodes in one pass.
+    static SortedList fromSorted(const std::vector<int>& values);
+
+    // Replaces the values with values sorted in ascending order, linked as fromSorted does,
+    // but keeps the settings of this list (capacity, lazy deletion, filter, log). A bounded
+    // list evicts past its capacity, and an attached log gets the new values as a snapshot.
+    void assignSorted(const std::vector<int>& values);
+
+    // Merges any number of lists into one holding every value of every list, in a single
+    // k-way pass with a loser tree: O(n log k) comparisons for n values in k lists.
+    // The rvalue overload moves the input nodes into the result instead of copying them and
+    // leaves lists empty. With threads > 1 (0: every hardware thread) a large merge splits
+    // the key range into slices that are merged on separate threads and then spliced.
+    static SortedList mergeAll(const std::vector<SortedList>& lists, unsigned threads = 1);
+    static SortedList mergeAll(std::vector<SortedList>&& lists, unsigned threads = 1);
 
     // Public Members
     // Returns true if the list is empty
     bool isEmpty() const;
 
-    // Inserts a new element to the list
+    // Returns the number of values stored in the list
+    size_t size() const;
+
+    // Inserts a new element to the list. Values at or past either end are linked in O(1);
+    // the others are placed by scanning from the end whose value is closer.
     void insert(int value);
 
     // Removes an element from the list
     bool remove(int value);
 
+    // Inserts value unless the list is at capacity and value would be evicted right away
+    // (see setCapacity). Returns true if the value was kept.
+    bool offer(int value);
+
+    // Removes and returns the first / last item in O(1). Throws std::out_of_range if list is empty.
+    int popFirst();
+    int popLast();
+
+    // Bounds the list to capacity values (0: unbounded), as a top-K buffer. When full, an
+    // insert that cannot make the cut is rejected in O(1); otherwise the value at the evicted
+    // end is dropped in O(1). Values above the new capacity are evicted immediately.
+    void setCapacity(size_t capacity, KeepPolicy keep = KeepPolicy::Largest);
+    size_t getCapacity() const;
+
     // Returns true if element exists in the list, false otherwise
+    // With a filter attached search updates its statistics, so concurrent calls race then.
     bool search(int value) const;
 
     // Prints the values in ascending order
     void printList() const;
 
+    // Appends the values in ascending order to out.
+    void appendInOrder(std::vector<int>& out) const;
+
+    // Appends the values in [low, high] in ascending order to out, at most limit of them.
+    void appendRange(int low, int high, std::vector<int>& out, size_t limit = SIZE_MAX) const;
+
     // Returns the first item in the list. Throws std::out_of_range if list is empty.
     int getFirst() const;
 
+    // Returns the last item in the list in O(1). Throws std::out_of_range if list is empty.
+    int getLast() const;
+
+    // Membership filter
+    // Attaches a counting Bloom filter so most searches for missing values return
+    // without scanning the list. expected_keys sizes the filter (0: use the current size);
+    // the filter is rebuilt larger when the list outgrows it.
+    void enableFilter(size_t expected_keys = 0);
+    // Detaches and frees the membership filter.
+    void disableFilter();
+    // Returns true if a membership filter is attached.
+    bool hasFilter() const;
+
+    // Lazy deletion
+    // Makes remove mark values deleted (tombstones) instead of unlinking and freeing them.
+    // Searches, printing and comparisons skip tombstones, and once they exceed purge_ratio
+    // of the linked nodes they are unlinked together in one pass over the list. With
+    // background_reclaim the purged nodes are freed on a background thread instead of by
+    // the caller. Throws std::invalid_argument unless 0 < purge_ratio <= 1.
+    void enableLazyDelete(double purge_ratio = 0.25, bool background_reclaim = false);
+    // Purges the tombstones and goes back to unlinking on remove.
+    void disableLazyDelete();
+    // Unlinks every tombstone in a single pass. Returns how many were unlinked.
+    size_t purge();
+    // Returns the number of removed values still linked as tombstones.
+    size_t tombstoneCount() const;
+
+    // Write-ahead log
+    // Appends every successful insert and remove to log, which must outlive the
+    // attachment. Copies of the list are not attached; a moved list keeps the log.
+    // Assigning to an attached list keeps its log and writes the new values to it as a
+    // snapshot (OperationLog::compact), so the assignment may throw its I/O errors.
+    void attachLog(OperationLog* log);
+    // Stops logging.
+    void detachLog();
+
+    // Set algebra over the distinct values of two lists. Each returns a new list
+    // holding every value once, built in a single pass over both lists.
+    SortedList unionWith(const SortedList& other) const;
+    SortedList intersect(const SortedList& other) const;
+    SortedList difference(const SortedList& other) const;
+    SortedList symmetricDifference(const SortedList& other) const;
+
+    // Returns an immutable, compressed copy of the values (see FrozenSortedList), which
+    // takes a fraction of the memory of the nodes. The list itself is not changed.
+    FrozenSortedList compact() const;
+
+    // Returns the bytes used by the list: the object (inline values included), the nodes
+    // (tombstones included) and the filter, before malloc overhead.
+    size_t memoryBytes() const;
+
+    // Prints the size of the list, the tombstone ratio and the filter statistics.
+    void printStats(std::ostream& os = std::cout) const;
+
     // Operators
     // Concatenate objects
     SortedList operator+(const SortedList& other) const;
@@ -90,4 +272,4 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const SortedList& list);
 };
 
-#endif // SORTED_LIST_H
\ No newline at end of file
+#endif // SORTED_LIST_H
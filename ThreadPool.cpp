@@ -0,0 +1,192 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "ThreadPool.h"
+#include <stdexcept>
+
+// The pool and queue of the current thread, set for workers and for the thread inside run(),
+// and the job of the task it is running (nullptr: none)
+static thread_local const ThreadPool* t_pool = nullptr;
+static thread_local size_t t_queue = 0;
+static thread_local void* t_job = nullptr;
+
+ThreadPool::ThreadPool(unsigned threads)
+    : queued(0), busy(0), sleepers(0), stopping(false) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (unsigned i = 0; i + 1 < threads; i++) {
+        workers.push_back(std::thread(&ThreadPool::_workerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+// Helper to take a task
+// The own queue is used as a stack, the others are robbed from the other end
+bool ThreadPool::_take(size_t self, Entry& entry) {
+    if (queued.load() == 0) {
+        return false;
+    }
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            entry.task.swap(own.tasks.back().task);
+            entry.job = own.tasks.back().job;
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        Queue& victim = *queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            entry.task.swap(victim.tasks.front().task);
+            entry.job = victim.tasks.front().job;
+            victim.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Helper to run one task
+// Counting the task finished is the last access to its job, whose run() may return right after
+void ThreadPool::_execute(Entry& entry) {
+    Job* job = entry.job;
+    void* outer_job = t_job;
+    t_job = job;
+    busy++;
+    try {
+        entry.task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(job->error_mutex);
+        if (!job->error) {
+            job->error = std::current_exception();
+        }
+    }
+    entry.task = Task();
+    busy--;
+    t_job = outer_job;
+    job->pending--;
+}
+
+// Helper to run a job
+// Waiting for the job's own count, not for every queue to drain, lets a task run a nested job
+// while tasks of the outer one are still in flight
+void ThreadPool::_runJob(size_t self, Job& job, const Task& task) {
+    void* outer_job = t_job;
+    t_job = &job;
+    spawn(task);
+    t_job = outer_job;
+    Entry next;
+    while (job.pending.load() > 0) {
+        if (_take(self, next)) {
+            _execute(next);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Helper for a worker thread
+// Sleeps only after announcing itself in sleepers and finding no task, so a spawn that
+// misses the announcement still finds the task counted in queued before sleeping starts
+void ThreadPool::_workerLoop(size_t self) {
+    t_pool = this;
+    t_queue = self;
+    Entry entry;
+    for (;;) {
+        if (_take(self, entry)) {
+            _execute(entry);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleepers++;
+        while (!stopping && queued.load() == 0) {
+            wake.wait(lock);
+        }
+        sleepers--;
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::run(const Task& task) {
+    Job job;
+    if (t_pool == this) {
+        // Nested in a task of this pool: the thread already owns a queue
+        _runJob(t_queue, job, task);
+    } else {
+        std::lock_guard<std::mutex> run_lock(run_mutex);
+        const ThreadPool* outer_pool = t_pool;
+        size_t outer_queue = t_queue;
+        t_pool = this;
+        t_queue = queues.size() - 1;
+        _runJob(t_queue, job, task);
+        t_pool = outer_pool;
+        t_queue = outer_queue;
+    }
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void ThreadPool::spawn(const Task& task) {
+    if (t_pool != this || t_job == nullptr) {
+        throw std::logic_error("ThreadPool::spawn must be called from a task of the pool.");
+    }
+    Job* job = static_cast<Job*>(t_job);
+    job->pending++;
+    {
+        Queue& queue = *queues[t_queue];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        Entry entry;
+        entry.task = task;
+        entry.job = job;
+        queue.tasks.push_back(entry);
+        queued++;
+    }
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        wake.notify_one();
+    }
+}
+
+bool ThreadPool::wantsWork() const {
+    return busy.load(std::memory_order_relaxed) < queues.size() && queued.load(std::memory_order_relaxed) == 0;
+}
+
+unsigned ThreadPool::size() const {
+    return static_cast<unsigned>(queues.size());
+}
+
+unsigned ThreadPool::currentThread() const {
+    return t_pool == this ? static_cast<unsigned>(t_queue) : size();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
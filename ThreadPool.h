@@ -0,0 +1,109 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for fork-join jobs such as the parallel tree traversals.
+//
+// Every worker (and the thread inside run()) owns a deque of tasks: it pushes the tasks it
+// spawns at the back and pops its own work from the back, so recently split (cache-warm)
+// work runs first, while an idle worker steals from the front of another deque, where the
+// oldest and usually largest tasks are. Idle workers sleep until a task is spawned.
+//
+// Every run() is a job with its own count of unfinished tasks, so a task may call run() again
+// (a nested traversal): the nested job's tasks go to the calling thread's deque and that thread
+// keeps running tasks, of any job, until its own job is done.
+class ThreadPool {
+private:
+    typedef std::function<void()> Task;
+
+    // The tasks of one run() not finished yet and the first exception one of them threw
+    struct Job {
+        std::atomic<size_t> pending;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        Job() : pending(0) {}
+    };
+
+    struct Entry {
+        Task task;
+        Job* job;
+
+        Entry() : job(nullptr) {}
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Entry> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue> > queues; // one per worker, the last one for the run() caller
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued;                 // tasks waiting in any queue
+    std::atomic<unsigned> busy;                 // threads running a task
+    std::atomic<unsigned> sleepers;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::mutex run_mutex;                       // one run() from outside the pool at a time
+
+    // Helper to take a task: the back of the own queue first, then the front of the others
+    bool _take(size_t self, Entry& entry);
+
+    // Helper to run one task and record its exception in its job
+    void _execute(Entry& entry);
+
+    // Helper to run task as job from queue self, working on any task until the job is done
+    void _runJob(size_t self, Job& job, const Task& task);
+
+    // Helper for the body of a worker thread
+    void _workerLoop(size_t self);
+
+    // A pool owns its threads
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+public:
+    // Starts threads - 1 workers (0: one per hardware thread); the thread calling run() is the last one.
+    explicit ThreadPool(unsigned threads = 0);
+
+    // Stops and joins the workers.
+    ~ThreadPool();
+
+    // Runs task and every task spawned while it runs, and returns once all of them finished.
+    // The calling thread works on the tasks too. Rethrows the first exception a task threw.
+    // May be called from inside a task of this pool.
+    void run(const Task& task);
+
+    // Queues a task of the run() whose task calls it. Throws std::logic_error outside a task.
+    void spawn(const Task& task);
+
+    // Returns true if some thread is idle and no task is waiting, so splitting work would help.
+    bool wantsWork() const;
+
+    // Returns the number of threads run() uses, the caller included.
+    unsigned size() const;
+
+    // Returns the index of the pool thread running the caller, in [0, size()), or size() when
+    // the caller is not a thread of this pool.
+    unsigned currentThread() const;
+
+    // Returns the process-wide pool, created with one thread per hardware thread on first use.
+    static ThreadPool& shared();
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,396 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef TREE_MAP_H
+#define TREE_MAP_H
+
+#include "Scapegoat.h"
+#include <climits>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Map mode of BinaryTree: every node holds an int key and its payload V, so a lookup finds
+// the payload in the same descent that finds the key, instead of a tree search followed by
+// a lookup in a separate hash map. V can be the payload itself or a handle to it.
+//
+// Keys are unique. find, insertOrAssign, operator[] and update each walk down the tree once.
+// Nodes are only relinked, never moved or copied, so a pointer returned by find stays valid
+// until its key is removed. Iteration is in ascending key order.
+//
+// The shape is kept like BinaryTree::setBalance does (scapegoat rebuilds), on by default with
+// alpha kDefaultBalance so keys inserted in sorted order do not degenerate the tree.
+template <typename V>
+class TreeMap {
+public:
+    static constexpr double kDefaultBalance = 0.7;
+
+private:
+    struct Node {
+        int key;
+        V value;
+        Node* left;
+        Node* right;
+
+        Node(int key, const V& value) : key(key), value(value), left(nullptr), right(nullptr) {}
+    };
+
+    Node* root;
+    size_t count;
+    double balance_alpha;          // 0: no shape maintenance
+    size_t max_count;              // largest size since the last full rebuild
+    unsigned long long rebuilds;
+    std::vector<Node**> path;      // links from the root to the last descent, reused between descents
+
+    // Helper to find the link holding key, or the empty link where it belongs. Records the
+    // links above it in path when the shape is maintained.
+    Node** _descend(int key) {
+        path.clear();
+        Node** link = &root;
+        while (*link != nullptr && (*link)->key != key) {
+            if (balance_alpha > 0) {
+                path.push_back(link);
+            }
+            link = key < (*link)->key ? &(*link)->left : &(*link)->right;
+        }
+        return link;
+    }
+
+    // Helper to find the node of key without changing anything
+    Node* _find(int key) const {
+        Node* node = root;
+        while (node != nullptr && node->key != key) {
+            node = key < node->key ? node->left : node->right;
+        }
+        return node;
+    }
+
+    // Helper to put a new node into the empty link found by _descend, then rebuild the
+    // scapegoat subtree if the node is deeper than the alpha height bound
+    Node* _link(Node** link, int key, const V& value) {
+        Node* node = new Node(key, value);
+        *link = node;
+        count++;
+        if (count > max_count) {
+            max_count = count;
+        }
+        if (balance_alpha <= 0 || !Scapegoat<Node>::tooDeep(path.size(), count, balance_alpha)) {
+            return node;
+        }
+        size_t size = 0;
+        Node** scapegoat = Scapegoat<Node>::findScapegoat(path, node, balance_alpha, size);
+        if (scapegoat != nullptr) {
+            _rebuild(scapegoat, size);
+        }
+        return node;
+    }
+
+    // Helper to rebuild the subtree at *link (size nodes) balanced, relinking its nodes in place
+    void _rebuild(Node** link, size_t size) {
+        Scapegoat<Node>::rebuild(link, size);
+        rebuilds++;
+    }
+
+    // Helper for deep copying a subtree without recursion: each pending pair is a node still
+    // to copy and the link its copy goes into. A failed allocation frees the partial copy.
+    static Node* _copy(const Node* node) {
+        Node* copy = nullptr;
+        std::vector<std::pair<const Node*, Node**> > pending;
+        if (node != nullptr) {
+            pending.push_back(std::make_pair(node, &copy));
+        }
+        try {
+            while (!pending.empty()) {
+                const Node* source = pending.back().first;
+                Node** link = pending.back().second;
+                pending.pop_back();
+                *link = new Node(source->key, source->value);
+                if (source->left != nullptr) {
+                    pending.push_back(std::make_pair(source->left, &(*link)->left));
+                }
+                if (source->right != nullptr) {
+                    pending.push_back(std::make_pair(source->right, &(*link)->right));
+                }
+            }
+        }
+        catch (...) {
+            _destroy(copy);
+            throw;
+        }
+        return copy;
+    }
+
+    // Helper to free a subtree without recursion: rotates left children up until there are none
+    static void _destroy(Node* node) {
+        while (node != nullptr) {
+            if (node->left != nullptr) {
+                Node* left = node->left;
+                node->left = left->right;
+                left->right = node;
+                node = left;
+            }
+            else {
+                Node* right = node->right;
+                delete node;
+                node = right;
+            }
+        }
+    }
+
+public:
+    // Constructor
+    TreeMap() : root(nullptr), count(0), balance_alpha(kDefaultBalance), max_count(0), rebuilds(0) {}
+    // Destructor
+    ~TreeMap() {
+        _destroy(root);
+    }
+
+    // Copy Constructor and Assignment Operator (deep copy)
+    TreeMap(const TreeMap& other)
+        : root(_copy(other.root)), count(other.count), balance_alpha(other.balance_alpha), max_count(other.count),
+          rebuilds(0) {}
+    TreeMap& operator=(const TreeMap& other) {
+        if (this == &other) {
+            return *this;
+        }
+        Node* copy = _copy(other.root);
+        _destroy(root);
+        root = copy;
+        count = other.count;
+        balance_alpha = other.balance_alpha;
+        max_count = other.count;
+        rebuilds = 0;
+        return *this;
+    }
+
+    // Move Constructor and Assignment Operator (take over the nodes of other, leaving it empty)
+    TreeMap(TreeMap&& other) noexcept
+        : root(other.root), count(other.count), balance_alpha(other.balance_alpha), max_count(other.max_count),
+          rebuilds(other.rebuilds) {
+        other.root = nullptr;
+        other.count = 0;
+        other.max_count = 0;
+    }
+    TreeMap& operator=(TreeMap&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        _destroy(root);
+        root = other.root;
+        count = other.count;
+        balance_alpha = other.balance_alpha;
+        max_count = other.max_count;
+        rebuilds = other.rebuilds;
+        other.root = nullptr;
+        other.count = 0;
+        other.max_count = 0;
+        return *this;
+    }
+
+    // Returns true if the map is empty.
+    bool isEmpty() const {
+        return count == 0;
+    }
+
+    // Returns the number of keys in the map.
+    size_t size() const {
+        return count;
+    }
+
+    // Returns the payload of key, or nullptr if key is not in the map.
+    V* find(int key) {
+        Node* node = _find(key);
+        return node != nullptr ? &node->value : nullptr;
+    }
+    const V* find(int key) const {
+        const Node* node = _find(key);
+        return node != nullptr ? &node->value : nullptr;
+    }
+
+    // Returns true if key is in the map.
+    bool contains(int key) const {
+        return _find(key) != nullptr;
+    }
+
+    // Sets the payload of key, adding key if it is missing. Returns true if key was added.
+    bool insertOrAssign(int key, const V& value) {
+        Node** link = _descend(key);
+        if (*link != nullptr) {
+            (*link)->value = value;
+            return false;
+        }
+        _link(link, key, value);
+        return true;
+    }
+
+    // Returns the payload of key, adding key with a default-constructed payload if it is missing.
+    V& operator[](int key) {
+        Node** link = _descend(key);
+        if (*link != nullptr) {
+            return (*link)->value;
+        }
+        return _link(link, key, V())->value;
+    }
+
+    // Calls fn(payload) on the payload of key in place. Returns false if key is not in the map.
+    template <typename Fn>
+    bool update(int key, Fn fn) {
+        Node* node = _find(key);
+        if (node == nullptr) {
+            return false;
+        }
+        fn(node->value);
+        return true;
+    }
+
+    // Removes key and its payload. Returns false if key is not in the map.
+    bool remove(int key) {
+        Node** link = _descend(key);
+        Node* node = *link;
+        if (node == nullptr) {
+            return false;
+        }
+        if (node->left == nullptr) {
+            *link = node->right;
+        }
+        else if (node->right == nullptr) {
+            *link = node->left;
+        }
+        else {
+            // The successor node takes the place of the removed one
+            Node** successor_link = &node->right;
+            while ((*successor_link)->left != nullptr) {
+                successor_link = &(*successor_link)->left;
+            }
+            Node* successor = *successor_link;
+            *successor_link = successor->right;
+            successor->left = node->left;
+            successor->right = node->right;
+            *link = successor;
+        }
+        delete node;
+        count--;
+        if (root != nullptr && balance_alpha > 0 && count < balance_alpha * max_count) {
+            _rebuild(&root, count);
+            max_count = count;
+        }
+        return true;
+    }
+
+    // Returns the smallest / largest key. Throws std::runtime_error if the map is empty.
+    int getMinKey() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Attempted to get min key from an empty map.");
+        }
+        const Node* node = root;
+        while (node->left != nullptr) {
+            node = node->left;
+        }
+        return node->key;
+    }
+    int getMaxKey() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Attempted to get max key from an empty map.");
+        }
+        const Node* node = root;
+        while (node->right != nullptr) {
+            node = node->right;
+        }
+        return node->key;
+    }
+
+    // Calls fn(key, payload) for every key in [low, high] in ascending order. Only the
+    // subtrees that overlap the range are visited.
+    template <typename Fn>
+    void forEachInRange(int low, int high, Fn fn) const {
+        std::vector<const Node*> pending;
+        const Node* node = root;
+        while (node != nullptr || !pending.empty()) {
+            if (node != nullptr) {
+                if (node->key < low) {
+                    node = node->right;
+                    continue;
+                }
+                pending.push_back(node);
+                node = node->left;
+                continue;
+            }
+            node = pending.back();
+            pending.pop_back();
+            if (node->key > high) {
+                return;
+            }
+            fn(node->key, node->value);
+            node = node->right;
+        }
+    }
+
+    // Calls fn(key, payload) for every key in ascending order.
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        forEachInRange(INT_MIN, INT_MAX, fn);
+    }
+
+    // Appends the keys in ascending order to out.
+    void appendKeysInOrder(std::vector<int>& out) const {
+        forEach([&out](int key, const V&) { out.push_back(key); });
+    }
+
+    // Shape maintenance, as BinaryTree::setBalance: 0 turns it off, otherwise alpha must be in
+    // (0.5, 1) (else std::invalid_argument). Enabling rebuilds the current tree.
+    void setBalance(double alpha) {
+        if (alpha != 0 && !(alpha > 0.5 && alpha < 1)) {
+            throw std::invalid_argument("Balance alpha must be 0 or in (0.5, 1).");
+        }
+        balance_alpha = alpha;
+        if (alpha > 0 && root != nullptr) {
+            _rebuild(&root, count);
+        }
+        max_count = count;
+    }
+    double getBalance() const {
+        return balance_alpha;
+    }
+
+    // Returns the number of nodes on the longest path from the root. O(n).
+    size_t height() const {
+        size_t height = 0;
+        std::vector<std::pair<const Node*, size_t> > pending;
+        if (root != nullptr) {
+            pending.push_back(std::make_pair(root, 1));
+        }
+        while (!pending.empty()) {
+            const Node* node = pending.back().first;
+            size_t depth = pending.back().second;
+            pending.pop_back();
+            if (depth > height) {
+                height = depth;
+            }
+            if (node->left != nullptr) {
+                pending.push_back(std::make_pair(node->left, depth + 1));
+            }
+            if (node->right != nullptr) {
+                pending.push_back(std::make_pair(node->right, depth + 1));
+            }
+        }
+        return height;
+    }
+
+    // Prints the size of the map and its memory.
+    void printStats(std::ostream& os = std::cout) const {
+        os << "TreeMap: size=" << count << " node_bytes=" << count * sizeof(Node);
+        if (balance_alpha > 0) {
+            os << " balance_alpha=" << balance_alpha << " rebuilds=" << rebuilds;
+        }
+        os << "\n";
+    }
+};
+
+template <typename V>
+constexpr double TreeMap<V>::kDefaultBalance;
+
+#endif // TREE_MAP_H
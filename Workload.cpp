@@ -0,0 +1,180 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#include "Workload.h"
+#include <cmath>
+#include <stdexcept>
+
+// --- WorkloadConfig ---
+
+WorkloadConfig::WorkloadConfig()
+    : pattern(KeyPattern::Uniform), key_count(10000), op_count(20000), key_range(20000),
+      read_ratio(0.9), zipf_theta(0.99), sawtooth_period(256), seed(42) {}
+
+// --- Random ---
+
+Random::Random(uint64_t seed) : state(seed) {}
+
+uint64_t Random::next() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t Random::nextBelow(uint64_t bound) {
+    // Rejection sampling removes the modulo bias
+    uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    uint64_t value;
+    do {
+        value = next();
+    } while (value >= limit);
+    return value % bound;
+}
+
+double Random::nextDouble() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// --- ZipfianGenerator ---
+
+// Helper to compute the generalized harmonic number H(n, theta)
+double ZipfianGenerator::_zeta(uint64_t n, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+        sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+}
+
+ZipfianGenerator::ZipfianGenerator(uint64_t n, double theta) : n(n), theta(theta) {
+    if (n == 0) {
+        throw std::invalid_argument("Zipfian generator needs a non-empty range.");
+    }
+    // alpha = 1 / (1 - theta) and the zeta(2) / zeta(n) ratio break down outside (0, 1)
+    if (!(theta > 0 && theta < 1)) {
+        throw std::invalid_argument("Zipfian theta must be in (0, 1).");
+    }
+    double zeta2 = _zeta(2, theta);
+    zetan = _zeta(n, theta);
+    alpha = 1.0 / (1.0 - theta);
+    eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+}
+
+uint64_t ZipfianGenerator::next(Random& rng) {
+    double u = rng.nextDouble();
+    double uz = u * zetan;
+    if (uz < 1.0) {
+        return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta)) {
+        return 1;
+    }
+    uint64_t rank = static_cast<uint64_t>(n * std::pow(eta * u - eta + 1.0, alpha));
+    return rank < n ? rank : n - 1;
+}
+
+// --- KeyGenerator ---
+
+KeyGenerator::KeyGenerator(const WorkloadConfig& config)
+    : config(config), rng(config.seed), position(0) {
+    if (config.key_range <= 0) {
+        throw std::invalid_argument("Workload key range must be positive.");
+    }
+    if (config.pattern == KeyPattern::Zipfian) {
+        zipf.reset(new ZipfianGenerator(config.key_range, config.zipf_theta));
+        // Shuffle rank -> key so the hot keys are not all clustered at one end of the range
+        zipf_keys.resize(config.key_range);
+        for (int i = 0; i < config.key_range; i++) {
+            zipf_keys[i] = i;
+        }
+        for (size_t i = zipf_keys.size() - 1; i > 0; i--) {
+            size_t j = static_cast<size_t>(rng.nextBelow(i + 1));
+            int temp = zipf_keys[i];
+            zipf_keys[i] = zipf_keys[j];
+            zipf_keys[j] = temp;
+        }
+    }
+}
+
+int KeyGenerator::next() {
+    uint64_t range = static_cast<uint64_t>(config.key_range);
+    uint64_t i = position++;
+    switch (config.pattern) {
+        case KeyPattern::Uniform:
+            return static_cast<int>(rng.nextBelow(range));
+        case KeyPattern::Zipfian:
+            return zipf_keys[zipf->next(rng)];
+        case KeyPattern::Sorted:
+            return static_cast<int>(i % range);
+        case KeyPattern::ReverseSorted:
+            return static_cast<int>(range - 1 - i % range);
+        case KeyPattern::Sawtooth: {
+            // Each run starts at a random base and climbs by one
+            uint64_t period = config.sawtooth_period > 0 ? config.sawtooth_period : 1;
+            uint64_t run = i / period;
+            uint64_t base = (run * 0x9E3779B97F4A7C15ULL) % range;
+            return static_cast<int>((base + i % period) % range);
+        }
+    }
+    throw std::logic_error("Unknown key pattern.");
+}
+
+// --- Workload builders ---
+
+std::vector<int> generateLoadKeys(const WorkloadConfig& config) {
+    KeyGenerator generator(config);
+    std::vector<int> keys;
+    keys.reserve(config.key_count);
+    for (size_t i = 0; i < config.key_count; i++) {
+        keys.push_back(generator.next());
+    }
+    return keys;
+}
+
+std::vector<Operation> generateOperations(const WorkloadConfig& config) {
+    // The mixed phase continues the key stream of the load phase
+    KeyGenerator generator(config);
+    for (size_t i = 0; i < config.key_count; i++) {
+        generator.next();
+    }
+    Random mix(config.seed ^ 0x5DEECE66DULL);
+    std::vector<Operation> ops;
+    ops.reserve(config.op_count);
+    for (size_t i = 0; i < config.op_count; i++) {
+        Operation op;
+        double roll = mix.nextDouble();
+        if (roll < config.read_ratio) {
+            op.type = OpType::Search;
+        } else if (roll < config.read_ratio + (1.0 - config.read_ratio) / 2) {
+            op.type = OpType::Insert;
+        } else {
+            op.type = OpType::Remove;
+        }
+        op.key = generator.next();
+        ops.push_back(op);
+    }
+    return ops;
+}
+
+const char* patternName(KeyPattern pattern) {
+    switch (pattern) {
+        case KeyPattern::Uniform: return "uniform";
+        case KeyPattern::Zipfian: return "zipfian";
+        case KeyPattern::Sorted: return "sorted";
+        case KeyPattern::ReverseSorted: return "reverse";
+        case KeyPattern::Sawtooth: return "sawtooth";
+    }
+    return "unknown";
+}
+
+KeyPattern parsePattern(const std::string& name) {
+    if (name == "uniform") return KeyPattern::Uniform;
+    if (name == "zipfian") return KeyPattern::Zipfian;
+    if (name == "sorted") return KeyPattern::Sorted;
+    if (name == "reverse") return KeyPattern::ReverseSorted;
+    if (name == "sawtooth") return KeyPattern::Sawtooth;
+    throw std::invalid_argument("Unknown key pattern: " + name);
+}
@@ -0,0 +1,116 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Shape of the key stream fed to a container.
+enum class KeyPattern {
+    Uniform,        // keys drawn uniformly from [0, key_range)
+    Zipfian,        // keys drawn from a Zipf distribution (a few keys are hot)
+    Sorted,         // 0, 1, 2, ... (worst case for an unbalanced tree)
+    ReverseSorted,  // n-1, n-2, ... 0
+    Sawtooth        // ascending runs of sawtooth_period keys
+};
+
+enum class OpType {
+    Insert,
+    Search,
+    Remove
+};
+
+struct Operation {
+    OpType type;
+    int key;
+};
+
+struct WorkloadConfig {
+    KeyPattern pattern;
+    size_t key_count;       // number of keys loaded before the mixed phase
+    size_t op_count;        // number of operations in the mixed phase
+    int key_range;          // keys are drawn from [0, key_range)
+    double read_ratio;      // fraction of mixed operations that are searches
+    double zipf_theta;      // skew of the Zipfian pattern (0.99 is the YCSB default)
+    size_t sawtooth_period; // length of an ascending run in the Sawtooth pattern
+    uint64_t seed;
+
+    WorkloadConfig();
+};
+
+// Small deterministic PRNG (splitmix64). The standard distributions are
+// implementation defined, so we do our own mapping to keep runs reproducible
+// across compilers and standard libraries.
+class Random {
+private:
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seed);
+
+    // Returns the next raw 64-bit value.
+    uint64_t next();
+
+    // Returns a value in [0, bound). bound must be positive.
+    uint64_t nextBelow(uint64_t bound);
+
+    // Returns a value in [0, 1).
+    double nextDouble();
+};
+
+// Zipf distributed ranks in [0, n), using the rejection-free method of
+// Gray et al. ("Quickly generating billion-record synthetic databases").
+// The method needs 0 < theta < 1, and construction is O(n).
+class ZipfianGenerator {
+private:
+    uint64_t n;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+
+    static double _zeta(uint64_t n, double theta);
+
+public:
+    // Throws std::invalid_argument if n is 0 or theta is outside (0, 1).
+    ZipfianGenerator(uint64_t n, double theta);
+
+    // Returns the next rank; rank 0 is the most popular.
+    uint64_t next(Random& rng);
+};
+
+// Produces the key stream for one pattern.
+class KeyGenerator {
+private:
+    WorkloadConfig config;
+    Random rng;
+    std::unique_ptr<ZipfianGenerator> zipf; // only built for the Zipfian pattern
+    std::vector<int> zipf_keys; // rank -> key, so hot keys are scattered over the range
+    uint64_t position;
+
+public:
+    explicit KeyGenerator(const WorkloadConfig& config);
+
+    // Returns the next key of the stream.
+    int next();
+};
+
+// Builds the keys loaded into a container before the mixed phase.
+std::vector<int> generateLoadKeys(const WorkloadConfig& config);
+
+// Builds the mixed phase: read_ratio searches, the rest split evenly between inserts and removes.
+std::vector<Operation> generateOperations(const WorkloadConfig& config);
+
+// Name used in reports and on the command line ("uniform", "zipfian", ...).
+const char* patternName(KeyPattern pattern);
+
+// Parses a pattern name. Throws std::invalid_argument on unknown names.
+KeyPattern parsePattern(const std::string& name);
+
+#endif // WORKLOAD_H
@@ -0,0 +1,1575 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+// Standalone benchmark for BinaryTree and SortedList.
+// Runs every public operation under the workloads from Workload.h and writes
+// the results as JSON (stdout, or --out <file>). Run with --help for options.
+
+#include "BinaryTree.h"
+#include "FrozenSortedList.h"
+#include "OperationLog.h"
+#include "RadixTree.h"
+#include "ShardedTree.h"
+#include "SortedList.h"
+#include "TreeMap.h"
+#include "Workload.h"
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <new>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// --- Allocation accounting ---
+// Every operator new in the process goes through these counters.
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+// GCC cannot see that the replaced operator new below is malloc based
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static std::atomic<uint64_t> g_allocations(0);
+static std::atomic<uint64_t> g_allocated_bytes(0);
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+// --- Measurement helpers ---
+
+typedef std::chrono::steady_clock Clock;
+
+// Swallows everything written to it; used to time the printing operations.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// Returns the peak resident set size of the process in kilobytes.
+static long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;        // kilobytes on Linux
+#endif
+}
+
+struct Result {
+    std::string container;
+    std::string scenario;
+    std::string pattern;
+    size_t ops;
+    double seconds;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    uint64_t memory_bytes;      // bytes the container keeps afterwards, 0 when not reported
+    long peak_rss_kb;
+};
+
+// Times one scenario: call measure() around every operation, then finish().
+class Scenario {
+private:
+    Result result;
+    std::vector<uint64_t> samples;
+    Clock::time_point start;
+    uint64_t start_allocations;
+    uint64_t start_bytes;
+
+    static uint64_t _percentile(const std::vector<uint64_t>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+
+public:
+    Scenario(const std::string& container, const std::string& scenario, const std::string& pattern,
+             size_t expected_ops) {
+        result.container = container;
+        result.scenario = scenario;
+        result.pattern = pattern;
+        result.memory_bytes = 0;
+        samples.reserve(expected_ops);
+        start_allocations = g_allocations.load();
+        start_bytes = g_allocated_bytes.load();
+        start = Clock::now();
+    }
+
+    template <typename Op>
+    void measure(Op op) {
+        Clock::time_point before = Clock::now();
+        op();
+        Clock::time_point after = Clock::now();
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+    }
+
+    // Records what the measured container keeps, which the allocated bytes overstate
+    // whenever the build grows or copies buffers it frees again.
+    void reportMemory(uint64_t bytes) {
+        result.memory_bytes = bytes;
+    }
+
+    Result finish() {
+        Clock::time_point end = Clock::now();
+        // Allocations are read before sorting so the bookkeeping is not counted
+        result.allocations = g_allocations.load() - start_allocations;
+        result.allocated_bytes = g_allocated_bytes.load() - start_bytes;
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        result.ops = samples.size();
+        std::sort(samples.begin(), samples.end());
+        result.p50_ns = _percentile(samples, 0.50);
+        result.p99_ns = _percentile(samples, 0.99);
+        result.p999_ns = _percentile(samples, 0.999);
+        result.max_ns = samples.empty() ? 0 : samples.back();
+        result.peak_rss_kb = peakRssKb();
+        return result;
+    }
+};
+
+struct Options {
+    WorkloadConfig workload;
+    std::vector<KeyPattern> patterns;
+    bool run_tree;
+    bool run_list;
+    size_t heavy_iterations; // repetitions of the O(n) operations (print, copy, concat, ...)
+    std::vector<std::string> suites;
+    std::string out_path;
+
+    Options() : run_tree(true), run_list(true), heavy_iterations(5) {}
+
+    // Returns true if the named suite was selected (all suites run by default)
+    bool runs(const std::string& suite) const {
+        return suites.empty() || std::find(suites.begin(), suites.end(), suite) != suites.end();
+    }
+};
+
+// Loads sorted keys median-first, which gives a perfectly balanced tree
+static void insertBalanced(BinaryTree& tree, const std::vector<int>& sorted, size_t lo, size_t hi) {
+    if (lo >= hi) {
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    tree.insert(sorted[mid]);
+    insertBalanced(tree, sorted, lo, mid);
+    insertBalanced(tree, sorted, mid + 1, hi);
+}
+
+// Returns the keys 0 .. count-1 in a random order
+static std::vector<int> shuffledKeys(size_t count, uint64_t seed) {
+    std::vector<int> keys(count);
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = static_cast<int>(i);
+    }
+    Random rng(seed);
+    for (size_t i = count; i > 1; i--) {
+        std::swap(keys[i - 1], keys[rng.nextBelow(i)]);
+    }
+    return keys;
+}
+
+// --- BinaryTree scenarios ---
+
+static void benchTree(const Options& options, KeyPattern pattern, std::vector<Result>& results) {
+    WorkloadConfig config = options.workload;
+    config.pattern = pattern;
+    std::string name = patternName(pattern);
+    std::vector<int> load = generateLoadKeys(config);
+    std::vector<Operation> ops = generateOperations(config);
+
+    BinaryTree tree;
+    {
+        Scenario s("BinaryTree", "insert", name, load.size());
+        for (size_t i = 0; i < load.size(); i++) {
+            int key = load[i];
+            s.measure([&] { tree.insert(key); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("BinaryTree", "search", name, ops.size());
+        volatile bool sink = false;
+        for (size_t i = 0; i < ops.size(); i++) {
+            int key = ops[i].key;
+            s.measure([&] { sink = tree.search(key); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        // Same lookups with the membership filter attached; most misses skip the tree walk
+        tree.enableFilter();
+        Scenario s("BinaryTree", "search_filtered", name, ops.size());
+        volatile bool sink = false;
+        for (size_t i = 0; i < ops.size(); i++) {
+            int key = ops[i].key;
+            s.measure([&] { sink = tree.search(key); });
+        }
+        results.push_back(s.finish());
+        tree.disableFilter();
+    }
+    {
+        Scenario s("BinaryTree", "min_max", name, 2 * ops.size());
+        volatile int sink = 0;
+        for (size_t i = 0; i < ops.size(); i++) {
+            s.measure([&] { sink = tree.getMinValue(); });
+            s.measure([&] { sink = tree.getMaxValue(); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        NullBuffer null_buffer;
+        std::ostream null_stream(&null_buffer);
+        std::streambuf* saved = std::cout.rdbuf(&null_buffer);
+        Scenario s("BinaryTree", "print", name, 2 * options.heavy_iterations);
+        for (size_t i = 0; i < options.heavy_iterations; i++) {
+            s.measure([&] { tree.printInOrder(); });
+            s.measure([&] { null_stream << tree; });
+        }
+        std::cout.rdbuf(saved);
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("BinaryTree", "copy", name, 2 * options.heavy_iterations);
+        for (size_t i = 0; i < options.heavy_iterations; i++) {
+            s.measure([&] { BinaryTree copy(tree); });
+            BinaryTree target;
+            s.measure([&] { target = tree; });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("BinaryTree", "mixed", name, ops.size());
+        for (size_t i = 0; i < ops.size(); i++) {
+            const Operation& op = ops[i];
+            s.measure([&] {
+                if (op.type == OpType::Search) {
+                    volatile bool found = tree.search(op.key);
+                    (void)found;
+                } else if (op.type == OpType::Insert) {
+                    tree += op.key;
+                } else if (!tree.isEmpty()) {
+                    try {
+                        tree.remove(op.key);
+                    } catch (const std::runtime_error&) {
+                        // Removing a missing key is part of the workload
+                    }
+                }
+            });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("BinaryTree", "remove", name, load.size());
+        for (size_t i = 0; i < load.size(); i++) {
+            int key = load[i];
+            s.measure([&] {
+                if (!tree.isEmpty()) {
+                    try {
+                        tree.remove(key);
+                    } catch (const std::runtime_error&) {
+                        // Already removed during the mixed phase
+                    }
+                }
+            });
+        }
+        results.push_back(s.finish());
+    }
+}
+
+// --- SortedList scenarios ---
+
+static void benchList(const Options& options, KeyPattern pattern, std::vector<Result>& results) {
+    WorkloadConfig config = options.workload;
+    config.pattern = pattern;
+    std::string name = patternName(pattern);
+    std::vector<int> load = generateLoadKeys(config);
+    std::vector<Operation> ops = generateOperations(config);
+
+    SortedList list;
+    {
+        Scenario s("SortedList", "insert", name, load.size());
+        for (size_t i = 0; i < load.size(); i++) {
+            int key = load[i];
+            s.measure([&] { list.insert(key); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("SortedList", "search", name, ops.size());
+        volatile bool sink = false;
+        for (size_t i = 0; i < ops.size(); i++) {
+            int key = ops[i].key;
+            s.measure([&] { sink = list.search(key); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        // Same lookups with the membership filter attached; most misses skip the list scan
+        list.enableFilter();
+        Scenario s("SortedList", "search_filtered", name, ops.size());
+        volatile bool sink = false;
+        for (size_t i = 0; i < ops.size(); i++) {
+            int key = ops[i].key;
+            s.measure([&] { sink = list.search(key); });
+        }
+        results.push_back(s.finish());
+        list.disableFilter();
+    }
+    {
+        Scenario s("SortedList", "get_first", name, ops.size());
+        volatile int sink = 0;
+        for (size_t i = 0; i < ops.size(); i++) {
+            s.measure([&] { sink = list.getFirst(); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        NullBuffer null_buffer;
+        std::ostream null_stream(&null_buffer);
+        std::streambuf* saved = std::cout.rdbuf(&null_buffer);
+        Scenario s("SortedList", "print", name, 2 * options.heavy_iterations);
+        for (size_t i = 0; i < options.heavy_iterations; i++) {
+            s.measure([&] { list.printList(); });
+            s.measure([&] { null_stream << list; });
+        }
+        std::cout.rdbuf(saved);
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("SortedList", "copy", name, 2 * options.heavy_iterations);
+        for (size_t i = 0; i < options.heavy_iterations; i++) {
+            s.measure([&] { SortedList copy(list); });
+            SortedList target;
+            s.measure([&] { target = list; });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("SortedList", "equals", name, options.heavy_iterations);
+        SortedList copy(list);
+        volatile bool sink = false;
+        for (size_t i = 0; i < options.heavy_iterations; i++) {
+            s.measure([&] { sink = (list == copy); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("SortedList", "concat", name, 3 * options.heavy_iterations);
+        SortedList small_list;
+        for (size_t i = 0; i < load.size() && i < 64; i++) {
+            small_list.insert(load[i]);
+        }
+        for (size_t i = 0; i < options.heavy_iterations; i++) {
+            int key = load.empty() ? 0 : load[i % load.size()];
+            s.measure([&] { SortedList sum = list + small_list; });
+            s.measure([&] { SortedList sum = list + key; });
+            s.measure([&] { SortedList sum = key + list; });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("SortedList", "mixed", name, ops.size());
+        for (size_t i = 0; i < ops.size(); i++) {
+            const Operation& op = ops[i];
+            s.measure([&] {
+                if (op.type == OpType::Search) {
+                    volatile bool found = list.search(op.key);
+                    (void)found;
+                } else if (op.type == OpType::Insert) {
+                    list += op.key;
+                } else {
+                    list.remove(op.key);
+                }
+            });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("SortedList", "remove", name, load.size());
+        for (size_t i = 0; i < load.size(); i++) {
+            int key = load[i];
+            s.measure([&] { list.remove(key); });
+        }
+        results.push_back(s.finish());
+    }
+}
+
+// --- Skewed lookups (self-adjusting access modes) ---
+
+// Zipf(theta) lookups of loaded keys against a randomly built tree, a perfectly
+// balanced tree and the self-adjusting access modes.
+static void benchSkewed(const Options& options, std::vector<Result>& results) {
+    WorkloadConfig config = options.workload;
+    config.pattern = KeyPattern::Zipfian;
+    config.key_range = static_cast<int>(config.key_count);
+    // A different seed than the lookups, so insertion order is unrelated to popularity
+    std::vector<int> load = shuffledKeys(config.key_count, config.seed * 31 + 7);
+    std::vector<int> sorted(load);
+    std::sort(sorted.begin(), sorted.end());
+    KeyGenerator lookups_generator(config);
+    std::vector<int> lookups(config.op_count);
+    for (size_t i = 0; i < lookups.size(); i++) {
+        lookups[i] = lookups_generator.next();
+    }
+
+    struct Variant {
+        const char* name;
+        bool balanced;
+        BinaryTree::AccessMode mode;
+        unsigned sample_period;
+    };
+    const Variant variants[] = {
+        {"BinaryTree/plain", false, BinaryTree::AccessMode::Plain, 1},
+        {"BinaryTree/balanced", true, BinaryTree::AccessMode::Plain, 1},
+        {"BinaryTree/semi_splay", false, BinaryTree::AccessMode::SemiSplay, 1},
+        {"BinaryTree/semi_splay_1_in_8", false, BinaryTree::AccessMode::SemiSplay, 8},
+        {"BinaryTree/move_to_root", false, BinaryTree::AccessMode::MoveToRoot, 1},
+    };
+    std::string pattern = "zipfian";
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+        BinaryTree tree;
+        if (variants[v].balanced) {
+            insertBalanced(tree, sorted, 0, sorted.size());
+        } else {
+            for (size_t i = 0; i < load.size(); i++) {
+                tree.insert(load[i]);
+            }
+        }
+        tree.setAccessMode(variants[v].mode, variants[v].sample_period);
+        Scenario s(variants[v].name, "skewed_search", pattern, lookups.size());
+        volatile bool sink = false;
+        for (size_t i = 0; i < lookups.size(); i++) {
+            int key = lookups[i];
+            s.measure([&] { sink = tree.search(key); });
+        }
+        results.push_back(s.finish());
+    }
+}
+
+// --- Set algebra ---
+
+// Runs the four set operations once each on a pair of containers
+template <typename Container>
+static void benchSetPair(const std::string& container, const std::string& shape, const Container& a,
+                         const Container& b, std::vector<Result>& results) {
+    Scenario s(container, "set_ops", shape, 4);
+    s.measure([&] { Container result = a.unionWith(b); });
+    s.measure([&] { Container result = a.intersect(b); });
+    s.measure([&] { Container result = a.difference(b); });
+    s.measure([&] { Container result = a.symmetricDifference(b); });
+    results.push_back(s.finish());
+}
+
+// Equal sized and very uneven inputs (1000:1); the baseline intersects with one search per key
+static void benchSetAlgebra(const Options& options, std::vector<Result>& results) {
+    WorkloadConfig config = options.workload;
+    config.pattern = KeyPattern::Uniform;
+    std::vector<int> large_keys = generateLoadKeys(config);
+    config.seed = config.seed * 31 + 7;
+    std::vector<int> other_keys = generateLoadKeys(config);
+    std::vector<int> small_keys(other_keys.begin(), other_keys.begin() + other_keys.size() / 1000);
+
+    if (options.run_tree) {
+        BinaryTree large_tree, other_tree, small_tree;
+        for (size_t i = 0; i < large_keys.size(); i++) {
+            large_tree.insert(large_keys[i]);
+        }
+        for (size_t i = 0; i < other_keys.size(); i++) {
+            other_tree.insert(other_keys[i]);
+        }
+        for (size_t i = 0; i < small_keys.size(); i++) {
+            small_tree.insert(small_keys[i]);
+        }
+        benchSetPair("BinaryTree", "equal", large_tree, other_tree, results);
+        benchSetPair("BinaryTree", "uneven", large_tree, small_tree, results);
+        {
+            // The uneven intersection alone: the three other operations output the large tree
+            Scenario s("BinaryTree", "intersect", "uneven", 1);
+            s.measure([&] { BinaryTree result = large_tree.intersect(small_tree); });
+            results.push_back(s.finish());
+        }
+
+        const std::vector<int>* probes[] = {&other_keys, &small_keys};
+        const char* shapes[] = {"equal", "uneven"};
+        for (size_t p = 0; p < 2; p++) {
+            const std::vector<int>& keys = *probes[p];
+            Scenario s("BinaryTree", "intersect_by_search", shapes[p], 1);
+            s.measure([&] {
+                BinaryTree result;
+                for (size_t i = 0; i < keys.size(); i++) {
+                    if (large_tree.search(keys[i]) && !result.search(keys[i])) {
+                        result.insert(keys[i]);
+                    }
+                }
+            });
+            results.push_back(s.finish());
+        }
+    }
+    if (options.run_list) {
+        SortedList large_list, other_list, small_list;
+        for (size_t i = 0; i < large_keys.size(); i++) {
+            large_list.insert(large_keys[i]);
+        }
+        for (size_t i = 0; i < other_keys.size(); i++) {
+            other_list.insert(other_keys[i]);
+        }
+        for (size_t i = 0; i < small_keys.size(); i++) {
+            small_list.insert(small_keys[i]);
+        }
+        benchSetPair("SortedList", "equal", large_list, other_list, results);
+        benchSetPair("SortedList", "uneven", large_list, small_list, results);
+
+        Scenario s("SortedList", "intersect_by_search", "equal", 1);
+        s.measure([&] {
+            SortedList result;
+            for (size_t i = 0; i < other_keys.size(); i++) {
+                if (large_list.search(other_keys[i]) && !result.search(other_keys[i])) {
+                    result.insert(other_keys[i]);
+                }
+            }
+        });
+        results.push_back(s.finish());
+    }
+}
+
+// --- Batched lookups ---
+
+// Batches of 1024 lookups: one search() call per key against one interleaved searchMany()
+static void benchBatchedLookups(const Options& options, std::vector<Result>& results) {
+    const size_t batch_size = 1024;
+    WorkloadConfig config = options.workload;
+    config.pattern = KeyPattern::Uniform;
+    std::vector<int> load = generateLoadKeys(config);
+    std::vector<Operation> ops = generateOperations(config);
+    BinaryTree tree;
+    for (size_t i = 0; i < load.size(); i++) {
+        tree.insert(load[i]);
+    }
+    std::vector<std::vector<int> > batches;
+    for (size_t i = 0; i + batch_size <= ops.size(); i += batch_size) {
+        std::vector<int> batch(batch_size);
+        for (size_t j = 0; j < batch_size; j++) {
+            batch[j] = ops[i + j].key;
+        }
+        batches.push_back(batch);
+    }
+
+    {
+        Scenario s("BinaryTree", "search_batch_1024", "uniform", batches.size());
+        std::vector<bool> found(batch_size);
+        for (size_t b = 0; b < batches.size(); b++) {
+            const std::vector<int>& batch = batches[b];
+            s.measure([&] {
+                for (size_t j = 0; j < batch.size(); j++) {
+                    found[j] = tree.search(batch[j]);
+                }
+            });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("BinaryTree", "search_many_1024", "uniform", batches.size());
+        std::vector<bool> found;
+        for (size_t b = 0; b < batches.size(); b++) {
+            const std::vector<int>& batch = batches[b];
+            s.measure([&] { tree.searchMany(batch, found); });
+        }
+        results.push_back(s.finish());
+    }
+}
+
+// --- Sharded ingestion ---
+
+// Loads the same keys into one BinaryTree and into a ShardedTree with one shard per
+// hardware thread, then runs the same lookups against both. The sharded tree is
+// created for the workload's key range so every shard starts with an equal slice.
+static void benchSharded(const Options& options, std::vector<Result>& results) {
+    WorkloadConfig config = options.workload;
+    config.pattern = KeyPattern::Uniform;
+    std::vector<int> load = generateLoadKeys(config);
+    std::vector<Operation> ops = generateOperations(config);
+
+    BinaryTree tree;
+    {
+        Scenario s("BinaryTree", "ingest", "uniform", 1);
+        s.measure([&] {
+            for (size_t i = 0; i < load.size(); i++) {
+                tree.insert(load[i]);
+            }
+        });
+        results.push_back(s.finish());
+    }
+    ShardedTree sharded(0, 0, config.key_range - 1);
+    {
+        Scenario s("ShardedTree", "ingest", "uniform", 1);
+        s.measure([&] { sharded.bulkInsert(load); });
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("ShardedTree", "search", "uniform", ops.size());
+        volatile bool sink = false;
+        for (size_t i = 0; i < ops.size(); i++) {
+            int key = ops[i].key;
+            s.measure([&] { sink = sharded.search(key); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        // Skewed writes: the rebalancer splits the shards that take the traffic
+        config.pattern = KeyPattern::Zipfian;
+        std::vector<Operation> skewed = generateOperations(config);
+        Scenario s("ShardedTree", "mixed", "zipfian", skewed.size());
+        for (size_t i = 0; i < skewed.size(); i++) {
+            const Operation& op = skewed[i];
+            s.measure([&] {
+                if (op.type == OpType::Search) {
+                    volatile bool found = sharded.search(op.key);
+                    (void)found;
+                } else if (op.type == OpType::Insert) {
+                    sharded.insert(op.key);
+                } else {
+                    try {
+                        sharded.remove(op.key);
+                    } catch (const std::runtime_error&) {
+                        // Removing a missing key is part of the workload
+                    }
+                }
+            });
+        }
+        results.push_back(s.finish());
+    }
+}
+
+// --- Queue mode ---
+
+typedef std::priority_queue<int, std::vector<int>, std::greater<int> > MinHeap;
+
+// SortedList as a priority queue against std::priority_queue: a steady-state queue of
+// --keys entries where every operation pushes a key and pops the smallest, then a
+// top-100 filter over a stream of --ops keys. Uniform keys land anywhere in the list;
+// sorted keys (timestamps) always land at the back, the O(1) insert path.
+static void benchQueue(const Options& options, std::vector<Result>& results) {
+    const KeyPattern patterns[] = {KeyPattern::Uniform, KeyPattern::Sorted};
+    const size_t top_k = 100;
+    for (size_t p = 0; p < 2; p++) {
+        WorkloadConfig config = options.workload;
+        config.pattern = patterns[p];
+        config.key_count = config.key_count + config.op_count;
+        std::vector<int> keys = generateLoadKeys(config);
+        size_t queued = options.workload.key_count;
+        std::string pattern = patternName(patterns[p]);
+
+        {
+            SortedList list;
+            for (size_t i = 0; i < queued; i++) {
+                list.insert(keys[i]);
+            }
+            Scenario s("SortedList", "queue_push_pop", pattern, keys.size() - queued);
+            volatile int sink = 0;
+            for (size_t i = queued; i < keys.size(); i++) {
+                int key = keys[i];
+                s.measure([&] {
+                    list.insert(key);
+                    sink = list.popFirst();
+                });
+            }
+            results.push_back(s.finish());
+        }
+        {
+            MinHeap heap;
+            for (size_t i = 0; i < queued; i++) {
+                heap.push(keys[i]);
+            }
+            Scenario s("std::priority_queue", "queue_push_pop", pattern, keys.size() - queued);
+            volatile int sink = 0;
+            for (size_t i = queued; i < keys.size(); i++) {
+                int key = keys[i];
+                s.measure([&] {
+                    heap.push(key);
+                    sink = heap.top();
+                    heap.pop();
+                });
+            }
+            results.push_back(s.finish());
+        }
+        {
+            SortedList list;
+            list.setCapacity(top_k, SortedList::KeepPolicy::Largest);
+            Scenario s("SortedList", "top_k", pattern, keys.size());
+            for (size_t i = 0; i < keys.size(); i++) {
+                int key = keys[i];
+                s.measure([&] { list.offer(key); });
+            }
+            results.push_back(s.finish());
+        }
+        {
+            MinHeap heap;
+            Scenario s("std::priority_queue", "top_k", pattern, keys.size());
+            for (size_t i = 0; i < keys.size(); i++) {
+                int key = keys[i];
+                s.measure([&] {
+                    if (heap.size() < top_k) {
+                        heap.push(key);
+                    } else if (key > heap.top()) {
+                        heap.pop();
+                        heap.push(key);
+                    }
+                });
+            }
+            results.push_back(s.finish());
+        }
+    }
+}
+
+// --- Parallel traversals ---
+
+// Whole-tree aggregates on 1, 2, 4 and every hardware thread
+static void benchParallelTraversal(const Options& options, std::vector<Result>& results) {
+    std::vector<int> sorted = shuffledKeys(16 * options.workload.key_count, options.workload.seed);
+    std::sort(sorted.begin(), sorted.end());
+    BinaryTree tree = BinaryTree::fromSorted(sorted);
+    const unsigned thread_counts[] = {1, 2, 4, 0};
+    for (size_t t = 0; t < 4; t++) {
+        ThreadPool pool(thread_counts[t]);
+        std::string shape = "threads" + std::to_string(pool.size());
+        volatile long long sink = 0;
+        {
+            Scenario s("BinaryTree", "parallel_sum", shape, options.heavy_iterations);
+            for (size_t r = 0; r < options.heavy_iterations; r++) {
+                s.measure([&] {
+                    sink = tree.parallelReduce(0LL, [](int value) { return static_cast<long long>(value); },
+                                               [](long long a, long long b) { return a + b; }, pool);
+                });
+            }
+            results.push_back(s.finish());
+        }
+        {
+            Scenario s("BinaryTree", "parallel_count_if", shape, options.heavy_iterations);
+            for (size_t r = 0; r < options.heavy_iterations; r++) {
+                s.measure([&] { sink = tree.parallelCountIf([](int value) { return value % 3 == 0; }, pool); });
+            }
+            results.push_back(s.finish());
+        }
+        {
+            // Polynomial hash of the in-order sequence: associative but not commutative
+            typedef std::pair<uint64_t, uint64_t> Hash; // (hash, base^length)
+            Scenario s("BinaryTree", "parallel_reduce_ordered", shape, options.heavy_iterations);
+            for (size_t r = 0; r < options.heavy_iterations; r++) {
+                s.measure([&] {
+                    Hash hash = tree.parallelReduceOrdered(
+                        Hash(0, 1), [](int value) { return Hash(static_cast<uint32_t>(value), 1000003); },
+                        [](const Hash& a, const Hash& b) { return Hash(a.first * b.second + b.first, a.second * b.second); },
+                        pool);
+                    sink = static_cast<long long>(hash.first);
+                });
+            }
+            results.push_back(s.finish());
+        }
+    }
+}
+
+// --- Shape maintenance ---
+
+// Inserts --keys keys in orders that degenerate an unbalanced tree, then searches them,
+// with shape maintenance off and at two alphas. Zigzag alternates the smallest and largest
+// remaining key, which builds a path that turns at every node.
+static void benchShape(const Options& options, std::vector<Result>& results) {
+    const KeyPattern patterns[] = {KeyPattern::Sorted, KeyPattern::ReverseSorted, KeyPattern::Sawtooth, KeyPattern::Uniform};
+    const double alphas[] = {0, 0.75, 0.6};
+    for (size_t p = 0; p < 5; p++) {
+        std::vector<int> keys;
+        std::string pattern;
+        if (p < 4) {
+            WorkloadConfig config = options.workload;
+            config.pattern = patterns[p];
+            keys = generateLoadKeys(config);
+            pattern = patternName(patterns[p]);
+        } else {
+            for (size_t lo = 0, hi = options.workload.key_count; lo < hi;) {
+                keys.push_back(static_cast<int>(lo++));
+                if (lo < hi) {
+                    keys.push_back(static_cast<int>(--hi));
+                }
+            }
+            pattern = "zigzag";
+        }
+        for (size_t a = 0; a < 3; a++) {
+            std::string shape = pattern + (alphas[a] > 0 ? "/alpha" + std::to_string(alphas[a]).substr(0, 4) : "/plain");
+            BinaryTree tree;
+            tree.setBalance(alphas[a]);
+            {
+                Scenario s("BinaryTree", "adversarial_insert", shape, keys.size());
+                for (size_t i = 0; i < keys.size(); i++) {
+                    int key = keys[i];
+                    s.measure([&] { tree.insert(key); });
+                }
+                results.push_back(s.finish());
+            }
+            {
+                Random rng(options.workload.seed);
+                Scenario s("BinaryTree", "adversarial_search", shape, options.workload.op_count);
+                volatile bool sink = false;
+                for (size_t i = 0; i < options.workload.op_count; i++) {
+                    int key = keys[rng.nextBelow(keys.size())];
+                    s.measure([&] { sink = tree.search(key); });
+                }
+                results.push_back(s.finish());
+            }
+        }
+    }
+}
+
+// --- Radix tree ---
+
+// Loads keys, 16 * keys and 256 * keys values into a BinaryTree and a RadixTree, then searches
+// for random values (half of them present) and walks the values in order. Dense keys are a
+// permutation of 0 .. n-1; sparse keys are drawn from the whole int range.
+template <typename Tree>
+static void benchRadixEngine(const std::string& name, const std::string& shape, const std::vector<int>& keys,
+                             const std::vector<int>& probes, const Options& options, std::vector<Result>& results) {
+    Tree tree;
+    {
+        Scenario s(name, "engine_insert", shape, keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            int key = keys[i];
+            s.measure([&] { tree.insert(key); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s(name, "engine_search", shape, probes.size());
+        volatile bool sink = false;
+        for (size_t i = 0; i < probes.size(); i++) {
+            int key = probes[i];
+            s.measure([&] { sink = tree.search(key); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s(name, "engine_in_order", shape, options.heavy_iterations);
+        std::vector<int> out;
+        out.reserve(keys.size());
+        for (size_t r = 0; r < options.heavy_iterations; r++) {
+            out.clear();
+            s.measure([&] { tree.appendInOrder(out); });
+        }
+        results.push_back(s.finish());
+    }
+}
+
+static void benchRadix(const Options& options, std::vector<Result>& results) {
+    const size_t scales[] = {1, 16, 256};
+    for (size_t sc = 0; sc < 3; sc++) {
+        size_t n = scales[sc] * options.workload.key_count;
+        for (int sparse = 0; sparse < 2; sparse++) {
+            Random rng(options.workload.seed + n);
+            std::vector<int> keys = shuffledKeys(n, options.workload.seed);
+            if (sparse) {
+                for (size_t i = 0; i < n; i++) {
+                    keys[i] = static_cast<int>(static_cast<uint32_t>(rng.next()));
+                }
+            }
+            std::vector<int> probes(options.workload.op_count);
+            for (size_t i = 0; i < probes.size(); i++) {
+                probes[i] = i % 2 == 0 ? keys[rng.nextBelow(n)] : static_cast<int>(static_cast<uint32_t>(rng.next()));
+            }
+            std::string shape = std::string(sparse ? "sparse" : "dense") + "/n" + std::to_string(n);
+            benchRadixEngine<BinaryTree>("BinaryTree", shape, keys, probes, options, results);
+            benchRadixEngine<RadixTree>("RadixTree", shape, keys, probes, options, results);
+        }
+    }
+}
+
+// --- Frozen lists ---
+
+// Builds 16 * keys values as a SortedList and as its compacted FrozenSortedList (the build
+// reports memoryBytes() of each form, what the list keeps), then searches, iterates and
+// intersects both. Dense values are IDs with gaps of 1 to 3; sparse ones cover the int range.
+template <typename List>
+static void benchFrozenForm(const std::string& name, const std::string& shape, const List& list, const List& other,
+                            const std::vector<int>& probes, const Options& options, std::vector<Result>& results) {
+    {
+        Scenario s(name, "frozen_search", shape, probes.size());
+        volatile bool sink = false;
+        for (size_t i = 0; i < probes.size(); i++) {
+            int key = probes[i];
+            s.measure([&] { sink = list.search(key); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s(name, "frozen_iterate", shape, options.heavy_iterations);
+        std::vector<int> out;
+        out.reserve(list.size());
+        for (size_t r = 0; r < options.heavy_iterations; r++) {
+            out.clear();
+            s.measure([&] { list.appendInOrder(out); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s(name, "frozen_intersect", shape, options.heavy_iterations);
+        volatile size_t sink = 0;
+        for (size_t r = 0; r < options.heavy_iterations; r++) {
+            s.measure([&] { sink = list.intersect(other).size(); });
+        }
+        results.push_back(s.finish());
+    }
+}
+
+static void benchFrozen(const Options& options, std::vector<Result>& results) {
+    size_t n = 16 * options.workload.key_count;
+    // Searching a SortedList walks it, so fewer probes keep the suite short
+    size_t probe_count = std::min<size_t>(options.workload.op_count, 2000);
+    for (int sparse = 0; sparse < 2; sparse++) {
+        Random rng(options.workload.seed);
+        std::vector<int> values[2];
+        for (int v = 0; v < 2; v++) {
+            for (size_t i = 0; i < n; i++) {
+                values[v].push_back(static_cast<int>(sparse ? static_cast<uint32_t>(rng.next()) : i + i / 2 + rng.nextBelow(2)));
+            }
+            std::sort(values[v].begin(), values[v].end());
+        }
+        std::vector<int> probes(probe_count);
+        for (size_t i = 0; i < probes.size(); i++) {
+            probes[i] = i % 2 == 0 ? values[0][rng.nextBelow(n)] : static_cast<int>(static_cast<uint32_t>(rng.next()));
+        }
+        std::string shape = std::string(sparse ? "sparse" : "dense") + "/n" + std::to_string(n);
+
+        SortedList lists[2];
+        for (int v = 0; v < 2; v++) {
+            Scenario s("SortedList", "frozen_build", shape, 1);
+            s.measure([&] { lists[v] = SortedList::fromSorted(values[v]); });
+            s.reportMemory(lists[v].memoryBytes());
+            if (v == 0) {
+                results.push_back(s.finish());
+            }
+        }
+        FrozenSortedList frozen[2];
+        for (int v = 0; v < 2; v++) {
+            Scenario s("FrozenSortedList", "frozen_build", shape, 1);
+            s.measure([&] { frozen[v] = lists[v].compact(); });
+            s.reportMemory(frozen[v].memoryBytes());
+            if (v == 0) {
+                results.push_back(s.finish());
+            }
+        }
+        benchFrozenForm("SortedList", shape, lists[0], lists[1], probes, options, results);
+        benchFrozenForm("FrozenSortedList", shape, frozen[0], frozen[1], probes, options, results);
+    }
+}
+
+// --- Ordered map ---
+
+// Payload of the map suite, the size of a small record
+struct MapPayload {
+    uint64_t id;
+    uint64_t hits;
+};
+
+// Looks up, updates, adds and iterates keys with payloads, kept either as a BinaryTree for
+// the order plus an unordered_map for the payloads (two lookups per hit) or as a TreeMap.
+static void benchMap(const Options& options, std::vector<Result>& results) {
+    size_t n = 16 * options.workload.key_count;
+    std::vector<int> keys = shuffledKeys(n, options.workload.seed);
+    Random rng(options.workload.seed);
+    std::vector<int> probes(options.workload.op_count);
+    for (size_t i = 0; i < probes.size(); i++) {
+        probes[i] = static_cast<int>(rng.nextBelow(n));
+    }
+    std::string shape = "n" + std::to_string(n);
+
+    BinaryTree tree;
+    std::unordered_map<int, MapPayload> payloads;
+    TreeMap<MapPayload> map;
+    {
+        Scenario s("BinaryTree+unordered_map", "map_insert", shape, n);
+        for (size_t i = 0; i < n; i++) {
+            int key = keys[i];
+            s.measure([&] {
+                tree.insert(key);
+                payloads[key] = MapPayload{static_cast<uint64_t>(key), 0};
+            });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("TreeMap", "map_insert", shape, n);
+        for (size_t i = 0; i < n; i++) {
+            int key = keys[i];
+            s.measure([&] { map.insertOrAssign(key, MapPayload{static_cast<uint64_t>(key), 0}); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("BinaryTree+unordered_map", "map_lookup", shape, probes.size());
+        volatile uint64_t sink = 0;
+        for (size_t i = 0; i < probes.size(); i++) {
+            int key = probes[i];
+            s.measure([&] {
+                if (tree.search(key)) {
+                    sink = payloads.find(key)->second.id;
+                }
+            });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("TreeMap", "map_lookup", shape, probes.size());
+        volatile uint64_t sink = 0;
+        for (size_t i = 0; i < probes.size(); i++) {
+            int key = probes[i];
+            s.measure([&] {
+                const MapPayload* payload = map.find(key);
+                if (payload != nullptr) {
+                    sink = payload->id;
+                }
+            });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("BinaryTree+unordered_map", "map_update", shape, probes.size());
+        for (size_t i = 0; i < probes.size(); i++) {
+            int key = probes[i];
+            s.measure([&] {
+                if (tree.search(key)) {
+                    payloads[key].hits++;
+                }
+            });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("TreeMap", "map_update", shape, probes.size());
+        for (size_t i = 0; i < probes.size(); i++) {
+            int key = probes[i];
+            s.measure([&] { map.update(key, [](MapPayload& payload) { payload.hits++; }); });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("BinaryTree+unordered_map", "map_iterate", shape, options.heavy_iterations);
+        volatile uint64_t sink = 0;
+        std::vector<int> ordered;
+        ordered.reserve(n);
+        for (size_t r = 0; r < options.heavy_iterations; r++) {
+            s.measure([&] {
+                ordered.clear();
+                tree.appendInOrder(ordered);
+                uint64_t sum = 0;
+                for (size_t i = 0; i < ordered.size(); i++) {
+                    sum += payloads.find(ordered[i])->second.hits;
+                }
+                sink = sum;
+            });
+        }
+        results.push_back(s.finish());
+    }
+    {
+        Scenario s("TreeMap", "map_iterate", shape, options.heavy_iterations);
+        volatile uint64_t sink = 0;
+        for (size_t r = 0; r < options.heavy_iterations; r++) {
+            s.measure([&] {
+                uint64_t sum = 0;
+                map.forEach([&sum](int, const MapPayload& payload) { sum += payload.hits; });
+                sink = sum;
+            });
+        }
+        results.push_back(s.finish());
+    }
+}
+
+// --- K-way merge ---
+
+// Merges k lists holding 16 * keys values in total
+static void benchMergeAll(const Options& options, std::vector<Result>& results) {
+    const size_t ks[] = {16, 256, 4096};
+    size_t total = 16 * options.workload.key_count;
+    Random rng(options.workload.seed + 2);
+    for (size_t i = 0; i < 3; i++) {
+        size_t k = ks[i];
+        std::string shape = "k" + std::to_string(k);
+        std::vector<SortedList> lists;
+        for (size_t l = 0; l < k; l++) {
+            std::vector<int> values(total / k);
+            for (size_t v = 0; v < values.size(); v++) {
+                values[v] = static_cast<int>(rng.nextBelow(options.workload.key_range));
+            }
+            std::sort(values.begin(), values.end());
+            lists.push_back(SortedList::fromSorted(values));
+        }
+
+        if (k <= 256) {
+            // The old way: fold the lists with operator+, once (it is quadratic in k)
+            Scenario s("SortedList", "merge_chain_plus", shape, 1);
+            s.measure([&] {
+                SortedList merged;
+                for (size_t l = 0; l < k; l++) {
+                    merged = merged + lists[l];
+                }
+            });
+            results.push_back(s.finish());
+        }
+        {
+            Scenario s("SortedList", "merge_all", shape, options.heavy_iterations);
+            for (size_t r = 0; r < options.heavy_iterations; r++) {
+                s.measure([&] { SortedList merged = SortedList::mergeAll(lists); });
+            }
+            results.push_back(s.finish());
+        }
+        {
+            Scenario s("SortedList", "merge_all_relink", shape, options.heavy_iterations);
+            for (size_t r = 0; r < options.heavy_iterations; r++) {
+                std::vector<SortedList> inputs = lists;
+                s.measure([&] { SortedList merged = SortedList::mergeAll(std::move(inputs)); });
+            }
+            results.push_back(s.finish());
+        }
+        {
+            Scenario s("SortedList", "merge_all_parallel", shape, options.heavy_iterations);
+            for (size_t r = 0; r < options.heavy_iterations; r++) {
+                s.measure([&] { SortedList merged = SortedList::mergeAll(lists, 0); });
+            }
+            results.push_back(s.finish());
+        }
+    }
+}
+
+// --- Small containers ---
+
+// Builds many small containers and searches them, the case the inline storage is for
+template <typename Container>
+static void benchSmallContainers(const std::string& name, const Options& options, std::vector<Result>& results) {
+    const size_t sizes[] = {8, 32, 64};
+    const size_t instances = 2000;
+    for (size_t s = 0; s < 3; s++) {
+        size_t size = sizes[s];
+        Random rng(options.workload.seed + size);
+        std::vector<int> keys(instances * size);
+        for (size_t i = 0; i < keys.size(); i++) {
+            keys[i] = static_cast<int>(rng.nextBelow(4 * size));
+        }
+        std::string shape = "n" + std::to_string(size);
+
+        std::vector<Container> containers(instances);
+        {
+            Scenario scenario(name, "small_build", shape, instances);
+            for (size_t c = 0; c < instances; c++) {
+                scenario.measure([&] {
+                    for (size_t i = 0; i < size; i++) {
+                        containers[c].insert(keys[c * size + i]);
+                    }
+                });
+            }
+            results.push_back(scenario.finish());
+        }
+        {
+            Scenario scenario(name, "small_search", shape, options.workload.op_count);
+            volatile bool sink = false;
+            for (size_t i = 0; i < options.workload.op_count; i++) {
+                const Container& container = containers[rng.nextBelow(instances)];
+                int key = static_cast<int>(rng.nextBelow(4 * size));
+                scenario.measure([&] { sink = container.search(key); });
+            }
+            results.push_back(scenario.finish());
+        }
+    }
+}
+
+// --- Lazy deletion ---
+
+// Remove-heavy list workloads with eager unlinking and with tombstones
+static void benchLazyDelete(const Options& options, std::vector<Result>& results) {
+    const char* const modes[] = {"eager", "lazy", "lazy_background"};
+    std::vector<int> keys = shuffledKeys(options.workload.key_count, options.workload.seed);
+    std::vector<int> sorted_keys = keys;
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    Random rng(options.workload.seed + 1);
+
+    for (size_t m = 0; m < 3; m++) {
+        std::string mode = modes[m];
+        {
+            // Remove half of the keys in random order
+            SortedList list = SortedList::fromSorted(sorted_keys);
+            if (m > 0) {
+                list.enableLazyDelete(0.25, m == 2);
+            }
+            size_t removals = keys.size() / 2;
+            Scenario s("SortedList", "remove_burst", mode, removals);
+            for (size_t i = 0; i < removals; i++) {
+                int key = keys[i];
+                s.measure([&] { list.remove(key); });
+            }
+            results.push_back(s.finish());
+        }
+        {
+            // Steady churn: every removal is followed by an insert
+            SortedList list = SortedList::fromSorted(sorted_keys);
+            if (m > 0) {
+                list.enableLazyDelete(0.25, m == 2);
+            }
+            std::vector<int> present = keys;
+            Scenario s("SortedList", "remove_churn", mode, options.workload.op_count);
+            for (size_t i = 0; i < options.workload.op_count; i++) {
+                size_t slot = rng.nextBelow(present.size());
+                int old_key = present[slot];
+                int new_key = static_cast<int>(rng.nextBelow(options.workload.key_range));
+                present[slot] = new_key;
+                s.measure([&] {
+                    list.remove(old_key);
+                    list.insert(new_key);
+                });
+            }
+            results.push_back(s.finish());
+        }
+    }
+}
+
+// --- Write-ahead log ---
+
+// Creates an empty scratch directory for a log
+static std::string makeScratchDirectory() {
+    char path[] = "/tmp/oplog_bench_XXXXXX";
+    if (mkdtemp(path) == nullptr) {
+        throw std::runtime_error("Cannot create a scratch directory in /tmp");
+    }
+    return path;
+}
+
+// Deletes a scratch log directory and the files in it
+static void removeScratchDirectory(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+            unlink((path + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(dir);
+    rmdir(path.c_str());
+}
+
+// Logged writes under every durability level, then a bulk recovery of --ops logged operations.
+// Fsyncing every operation is orders of magnitude slower, so that level runs at most 1000 ops.
+static void benchOperationLog(const Options& options, std::vector<Result>& results) {
+    WorkloadConfig config = options.workload;
+    config.pattern = KeyPattern::Uniform;
+    std::vector<int> load = generateLoadKeys(config);
+    std::vector<Operation> ops = generateOperations(config);
+
+    const Durability levels[] = {Durability::None, Durability::GroupCommit, Durability::EveryOperation};
+    const char* names[] = {"logged_mixed_none", "logged_mixed_group_commit", "logged_mixed_every_op"};
+    for (size_t level = 0; level < 3; level++) {
+        std::string directory = makeScratchDirectory();
+        {
+            OperationLog log(directory, levels[level]);
+            BinaryTree tree;
+            for (size_t i = 0; i < load.size(); i++) {
+                tree.insert(load[i]);
+            }
+            tree.attachLog(&log);
+            size_t count = levels[level] == Durability::EveryOperation ? std::min<size_t>(ops.size(), 1000)
+                                                                         : ops.size();
+            Scenario s("BinaryTree", names[level], "uniform", count);
+            for (size_t i = 0; i < count; i++) {
+                const Operation& op = ops[i];
+                s.measure([&] {
+                    if (op.type == OpType::Search) {
+                        volatile bool found = tree.search(op.key);
+                        (void)found;
+                    } else if (op.type == OpType::Insert) {
+                        tree.insert(op.key);
+                    } else {
+                        try {
+                            tree.remove(op.key);
+                        } catch (const std::runtime_error&) {
+                            // Removing a missing key is part of the workload (and is not logged)
+                        }
+                    }
+                });
+            }
+            s.measure([&] { log.flush(); });
+            results.push_back(s.finish());
+        }
+        removeScratchDirectory(directory);
+    }
+
+    // Recovery: op_count logged operations, one in four a remove of an earlier insert
+    std::string directory = makeScratchDirectory();
+    {
+        OperationLog log(directory, Durability::None);
+        Random rng(config.seed);
+        std::vector<int> live;
+        for (size_t i = 0; i < config.op_count; i++) {
+            if (i % 4 == 3 && !live.empty()) {
+                size_t pick = rng.nextBelow(live.size());
+                log.logRemove(live[pick]);
+                live[pick] = live.back();
+                live.pop_back();
+            } else {
+                int key = static_cast<int>(rng.nextBelow(config.key_range));
+                log.logInsert(key);
+                live.push_back(key);
+            }
+        }
+    }
+    {
+        BinaryTree tree;
+        Scenario s("BinaryTree", "recover", "uniform", 1);
+        s.measure([&] { OperationLog::recover(directory, tree); });
+        Result result = s.finish();
+        result.ops = config.op_count;
+        results.push_back(result);
+    }
+    {
+        // Compaction cost on the caller: the snapshot itself is written in the background
+        BinaryTree tree;
+        OperationLog::recover(directory, tree);
+        OperationLog log(directory, Durability::GroupCommit);
+        Scenario s("BinaryTree", "compact", "uniform", 1);
+        s.measure([&] { log.compact(tree); });
+        results.push_back(s.finish());
+    }
+    removeScratchDirectory(directory);
+}
+
+// --- Report ---
+
+static void writeJson(std::ostream& os, const Options& options, const std::vector<Result>& results) {
+    const WorkloadConfig& w = options.workload;
+    os << "{\n";
+    os << "  \"config\": {\"keys\": " << w.key_count << ", \"ops\": " << w.op_count
+       << ", \"range\": " << w.key_range << ", \"read_ratio\": " << w.read_ratio
+       << ", \"zipf_theta\": " << w.zipf_theta << ", \"sawtooth_period\": " << w.sawtooth_period
+       << ", \"seed\": " << w.seed << ", \"heavy_iterations\": " << options.heavy_iterations << "},\n";
+    os << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        double throughput = r.seconds > 0 ? r.ops / r.seconds : 0;
+        os << "    {\"container\": \"" << r.container << "\", \"scenario\": \"" << r.scenario
+           << "\", \"pattern\": \"" << r.pattern << "\", \"ops\": " << r.ops
+           << ", \"seconds\": " << r.seconds << ", \"ops_per_sec\": " << throughput
+           << ", \"p50_ns\": " << r.p50_ns << ", \"p99_ns\": " << r.p99_ns
+           << ", \"p999_ns\": " << r.p999_ns << ", \"max_ns\": " << r.max_ns
+           << ", \"allocations\": " << r.allocations << ", \"allocated_bytes\": " << r.allocated_bytes
+           << ", \"memory_bytes\": " << r.memory_bytes << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+        os << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n";
+    os << "}\n";
+}
+
+// --- Command line ---
+
+static void printUsage() {
+    std::cerr << "Usage: benchmark [options]\n"
+              << "  --keys N          keys loaded before the mixed phase (default 10000)\n"
+              << "  --ops N           operations in the search and mixed phases (default 20000)\n"
+              << "  --range N         keys are drawn from [0, N) (default 2 * keys)\n"
+              << "  --read-ratio R    fraction of searches in the mixed phase (default 0.9)\n"
+              << "  --theta T         Zipfian skew, in (0, 1) (default 0.99)\n"
+              << "  --period N        Sawtooth run length (default 256)\n"
+              << "  --seed N          random seed (default 42)\n"
+              << "  --pattern P       uniform|zipfian|sorted|reverse|sawtooth, repeatable (default all)\n"
+              << "  --container C     tree|list|all (default all)\n"
+              << "  --suite S         core|skewed|setops|batch|sharded|wal|queue|small|lazy|merge|parallel|shape|radix|frozen|map, repeatable (default all)\n"
+              << "  --heavy N         repetitions of the O(n) operations (default 5)\n"
+              << "  --out FILE        write the JSON report to FILE instead of stdout\n";
+}
+
+static Options parseOptions(int argc, char* argv[]) {
+    Options options;
+    bool range_given = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--keys") {
+            options.workload.key_count = std::stoul(value);
+        } else if (arg == "--ops") {
+            options.workload.op_count = std::stoul(value);
+        } else if (arg == "--range") {
+            options.workload.key_range = std::stoi(value);
+            range_given = true;
+        } else if (arg == "--read-ratio") {
+            options.workload.read_ratio = std::stod(value);
+        } else if (arg == "--theta") {
+            options.workload.zipf_theta = std::stod(value);
+            if (!(options.workload.zipf_theta > 0 && options.workload.zipf_theta < 1)) {
+                throw std::invalid_argument("--theta must be in (0, 1)");
+            }
+        } else if (arg == "--period") {
+            options.workload.sawtooth_period = std::stoul(value);
+        } else if (arg == "--seed") {
+            options.workload.seed = std::stoull(value);
+        } else if (arg == "--pattern") {
+            options.patterns.push_back(parsePattern(value));
+        } else if (arg == "--container") {
+            options.run_tree = (value == "tree" || value == "all");
+            options.run_list = (value == "list" || value == "all");
+            if (!options.run_tree && !options.run_list) {
+                throw std::invalid_argument("Unknown container: " + value);
+            }
+        } else if (arg == "--suite") {
+            options.suites.push_back(value);
+        } else if (arg == "--heavy") {
+            options.heavy_iterations = std::stoul(value);
+        } else if (arg == "--out") {
+            options.out_path = value;
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    if (!range_given) {
+        // Half of the lookups miss by default
+        options.workload.key_range = static_cast<int>(2 * options.workload.key_count);
+    }
+    if (options.patterns.empty()) {
+        options.patterns.push_back(KeyPattern::Uniform);
+        options.patterns.push_back(KeyPattern::Zipfian);
+        options.patterns.push_back(KeyPattern::Sorted);
+        options.patterns.push_back(KeyPattern::ReverseSorted);
+        options.patterns.push_back(KeyPattern::Sawtooth);
+    }
+    return options;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Result> results;
+    if (options.runs("core")) {
+        for (size_t i = 0; i < options.patterns.size(); i++) {
+            if (options.run_tree) {
+                benchTree(options, options.patterns[i], results);
+            }
+            if (options.run_list) {
+                benchList(options, options.patterns[i], results);
+            }
+        }
+    }
+    if (options.runs("skewed") && options.run_tree) {
+        benchSkewed(options, results);
+    }
+    if (options.runs("setops")) {
+        benchSetAlgebra(options, results);
+    }
+    if (options.runs("batch") && options.run_tree) {
+        benchBatchedLookups(options, results);
+    }
+    if (options.runs("sharded") && options.run_tree) {
+        benchSharded(options, results);
+    }
+    if (options.runs("wal") && options.run_tree) {
+        benchOperationLog(options, results);
+    }
+    if (options.runs("queue") && options.run_list) {
+        benchQueue(options, results);
+    }
+    if (options.runs("lazy") && options.run_list) {
+        benchLazyDelete(options, results);
+    }
+    if (options.runs("parallel") && options.run_tree) {
+        benchParallelTraversal(options, results);
+    }
+    if (options.runs("shape") && options.run_tree) {
+        benchShape(options, results);
+    }
+    if (options.runs("radix") && options.run_tree) {
+        benchRadix(options, results);
+    }
+    if (options.runs("frozen") && options.run_list) {
+        benchFrozen(options, results);
+    }
+    if (options.runs("map") && options.run_tree) {
+        benchMap(options, results);
+    }
+    if (options.runs("merge") && options.run_list) {
+        benchMergeAll(options, results);
+    }
+    if (options.runs("small")) {
+        if (options.run_tree) {
+            benchSmallContainers<BinaryTree>("BinaryTree", options, results);
+        }
+        if (options.run_list) {
+            benchSmallContainers<SortedList>("SortedList", options, results);
+        }
+    }
+
+    if (options.out_path.empty()) {
+        writeJson(std::cout, options, results);
+    } else {
+        std::ofstream out(options.out_path.c_str());
+        if (!out) {
+            std::cerr << "Cannot open " << options.out_path << " for writing.\n";
+            return 1;
+        }
+        writeJson(out, options, results);
+    }
+    return 0;
+}
@@ -0,0 +1,319 @@
+/****************************************
+Assignment C++: 1
+Author: Adar Shapira, ID: 209580208
+        Almog Talker, ID: 322546680
+*****************************************/
+// Load generator for the server mode (./my_program --serve <socket>).
+// Every client thread keeps --pipeline requests in flight on its own connection
+// and times each request from the write that carried it to its response. The
+// throughput and latency percentiles are printed as JSON. Run with --help for options.
+
+#include "Protocol.h"
+#include "Workload.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct LoadOptions {
+    std::string socket_path;
+    unsigned clients;
+    size_t requests;        // per client
+    size_t pipeline;        // requests in flight per client
+    size_t preload;         // keys inserted before measuring
+    TargetContainer target;
+    double read_ratio;      // searches; the rest are inserts and removes in equal parts
+    double range_ratio;     // Range requests, taken out of the searches
+    int range_width;
+    int key_range;
+    uint64_t seed;
+
+    LoadOptions()
+        : socket_path("/tmp/containers.sock"), clients(4), requests(100000), pipeline(16), preload(100000),
+          target(TargetContainer::Tree), read_ratio(0.9), range_ratio(0.01), range_width(64),
+          key_range(1 << 20), seed(42) {}
+};
+
+struct Request {
+    Opcode opcode;
+    int value;
+    int high;
+};
+
+// Opens a blocking connection to the server
+static int connectTo(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::string reason = std::strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("Cannot connect to " + path + ": " + reason);
+    }
+    return fd;
+}
+
+static void encodeRequest(std::vector<char>& out, const Request& request, TargetContainer target) {
+    size_t offset = out.size();
+    size_t length = requestLength(static_cast<uint8_t>(request.opcode));
+    out.resize(offset + length);
+    out[offset] = static_cast<char>(request.opcode);
+    out[offset + 1] = static_cast<char>(target);
+    if (length >= 6) {
+        encodeInt32(&out[offset + 2], static_cast<uint32_t>(request.value));
+    }
+    if (length >= 10) {
+        encodeInt32(&out[offset + 6], static_cast<uint32_t>(request.high));
+    }
+}
+
+// Sends every request with at most depth in flight; appends the latency of each one to latencies
+// (when not null). Throws std::runtime_error if the connection fails.
+static void runRequests(int fd, const std::vector<Request>& requests, size_t depth, TargetContainer target,
+                        std::vector<uint64_t>* latencies) {
+    std::deque<std::pair<Opcode, Clock::time_point> > in_flight;
+    std::vector<char> out;
+    std::vector<char> in;
+    size_t parsed = 0;
+    size_t sent = 0;
+    size_t done = 0;
+    while (done < requests.size()) {
+        // Top the pipeline up with a single write
+        out.clear();
+        Clock::time_point now = Clock::now();
+        while (sent < requests.size() && in_flight.size() < depth) {
+            encodeRequest(out, requests[sent], target);
+            in_flight.push_back(std::make_pair(requests[sent].opcode, now));
+            sent++;
+        }
+        for (size_t written = 0; written < out.size();) {
+            ssize_t n = write(fd, out.data() + written, out.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+            }
+            written += n;
+        }
+
+        // Read whatever arrived and retire every complete response
+        size_t filled = in.size();
+        in.resize(filled + 64 * 1024);
+        ssize_t got = read(fd, &in[filled], 64 * 1024);
+        if (got < 0 && errno == EINTR) {
+            in.resize(filled);
+            continue;
+        }
+        if (got <= 0) {
+            throw std::runtime_error("Server closed the connection");
+        }
+        in.resize(filled + got);
+        Clock::time_point arrived = Clock::now();
+        while (!in_flight.empty()) {
+            size_t length = responseLength(in_flight.front().first, in.data() + parsed, in.size() - parsed);
+            if (length == 0) {
+                break;
+            }
+            if (static_cast<ResponseStatus>(in[parsed]) == ResponseStatus::BadRequest) {
+                throw std::runtime_error("Server rejected a request");
+            }
+            if (latencies != nullptr) {
+                latencies->push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(arrived - in_flight.front().second).count());
+            }
+            in_flight.pop_front();
+            parsed += length;
+            done++;
+        }
+        in.erase(in.begin(), in.begin() + parsed);
+        parsed = 0;
+    }
+}
+
+// Builds the request mix of one client
+static std::vector<Request> makeRequests(const LoadOptions& options, uint64_t seed) {
+    Random rng(seed);
+    std::vector<Request> requests(options.requests);
+    for (size_t i = 0; i < requests.size(); i++) {
+        Request& request = requests[i];
+        request.value = static_cast<int>(rng.nextBelow(options.key_range));
+        request.high = request.value + options.range_width - 1;
+        double roll = rng.nextDouble();
+        if (roll < options.range_ratio) {
+            request.opcode = Opcode::Range;
+        } else if (roll < options.read_ratio) {
+            request.opcode = Opcode::Search;
+        } else if (rng.nextBelow(2) == 0) {
+            request.opcode = Opcode::Insert;
+        } else {
+            request.opcode = Opcode::Remove;
+        }
+    }
+    return requests;
+}
+
+static uint64_t percentile(const std::vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5)];
+}
+
+static void printUsage() {
+    std::cerr << "Usage: loadgen [options]\n"
+              << "  --socket PATH     server socket (default /tmp/containers.sock)\n"
+              << "  --clients N       connections, one thread each (default 4)\n"
+              << "  --requests N      requests per client (default 100000)\n"
+              << "  --pipeline N      requests in flight per client (default 16)\n"
+              << "  --preload N       keys inserted before measuring (default 100000)\n"
+              << "  --container C     tree|list (default tree)\n"
+              << "  --read-ratio R    fraction of searches and ranges (default 0.9)\n"
+              << "  --range-ratio R   fraction of range requests (default 0.01)\n"
+              << "  --range-width N   keys covered by a range request (default 64)\n"
+              << "  --range N         keys are drawn from [0, N) (default 1048576)\n"
+              << "  --seed N          random seed (default 42)\n";
+}
+
+static LoadOptions parseOptions(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--socket") {
+            options.socket_path = value;
+        } else if (arg == "--clients") {
+            options.clients = static_cast<unsigned>(std::stoul(value));
+        } else if (arg == "--requests") {
+            options.requests = std::stoul(value);
+        } else if (arg == "--pipeline") {
+            options.pipeline = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--preload") {
+            options.preload = std::stoul(value);
+        } else if (arg == "--container") {
+            if (value != "tree" && value != "list") {
+                throw std::invalid_argument("Unknown container: " + value);
+            }
+            options.target = value == "tree" ? TargetContainer::Tree : TargetContainer::List;
+        } else if (arg == "--read-ratio") {
+            options.read_ratio = std::stod(value);
+        } else if (arg == "--range-ratio") {
+            options.range_ratio = std::stod(value);
+        } else if (arg == "--range-width") {
+            options.range_width = std::max(1, std::stoi(value));
+        } else if (arg == "--range") {
+            options.key_range = std::max(1, std::stoi(value));
+        } else if (arg == "--seed") {
+            options.seed = std::stoull(value);
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    if (options.clients == 0) {
+        throw std::invalid_argument("At least one client is needed");
+    }
+    return options;
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        printUsage();
+        return 1;
+    }
+
+    try {
+        // Preload on one connection, not measured
+        if (options.preload > 0) {
+            Random rng(options.seed ^ 0x5bd1e995);
+            std::vector<Request> inserts(options.preload);
+            for (size_t i = 0; i < inserts.size(); i++) {
+                inserts[i].opcode = Opcode::Insert;
+                inserts[i].value = static_cast<int>(rng.nextBelow(options.key_range));
+            }
+            int fd = connectTo(options.socket_path);
+            runRequests(fd, inserts, 256, options.target, nullptr);
+            close(fd);
+        }
+
+        std::vector<std::vector<Request> > plans(options.clients);
+        std::vector<int> sockets(options.clients);
+        for (unsigned c = 0; c < options.clients; c++) {
+            plans[c] = makeRequests(options, options.seed + c);
+            sockets[c] = connectTo(options.socket_path);
+        }
+
+        std::vector<std::vector<uint64_t> > latencies(options.clients);
+        std::vector<std::string> errors(options.clients);
+        std::vector<std::thread> clients;
+        Clock::time_point start = Clock::now();
+        for (unsigned c = 0; c < options.clients; c++) {
+            latencies[c].reserve(options.requests);
+            clients.push_back(std::thread([&, c] {
+                try {
+                    runRequests(sockets[c], plans[c], options.pipeline, options.target, &latencies[c]);
+                } catch (const std::exception& e) {
+                    errors[c] = e.what();
+                }
+            }));
+        }
+        for (unsigned c = 0; c < options.clients; c++) {
+            clients[c].join();
+            close(sockets[c]);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (unsigned c = 0; c < options.clients; c++) {
+            if (!errors[c].empty()) {
+                throw std::runtime_error("Client " + std::to_string(c) + ": " + errors[c]);
+            }
+        }
+
+        std::vector<uint64_t> all;
+        for (unsigned c = 0; c < options.clients; c++) {
+            all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        }
+        std::sort(all.begin(), all.end());
+        std::cout << "{\"clients\": " << options.clients << ", \"pipeline\": " << options.pipeline
+                  << ", \"container\": \"" << (options.target == TargetContainer::Tree ? "tree" : "list")
+                  << "\", \"requests\": " << all.size() << ", \"seconds\": " << seconds
+                  << ", \"requests_per_sec\": " << (seconds > 0 ? all.size() / seconds : 0)
+                  << ", \"p50_ns\": " << percentile(all, 0.50) << ", \"p99_ns\": " << percentile(all, 0.99)
+                  << ", \"p999_ns\": " << percentile(all, 0.999)
+                  << ", \"max_ns\": " << (all.empty() ? 0 : all.back()) << "}\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
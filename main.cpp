@@ -7,9 +7,13 @@
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
 	//simply creating a menu instance, then calling mainMenu(). the rest is inside mainMenu().
 	Menu a;
+	//"--serve <socket path>" serves the containers to local clients instead of the interactive menu.
+	if (argc == 3 && string(argv[1]) == "--serve") {
+		return a.serve(argv[2]) ? 0 : 1;
+	}
 	a.mainMenu();
 	return 0;
 }
@@ -4,6 +4,8 @@ Author: Adar Shapira, ID: 209580208
 		Almog Talker, ID: 322546680
 *****************************************/
 #include "Menu.h"
+#include "Server.h"
+#include <stdexcept>
 
 Menu::Menu() : tree(), list() {
 }
@@ -17,6 +19,19 @@ void Menu::mainMenu() {
     } while (choice != 3);
 }
 
+bool Menu::serve(const std::string& socket_path) {
+    try {
+        Server server(tree, list, socket_path);
+        std::cout << "Serving on " << socket_path << ", press Ctrl+C to stop.\n";
+        server.run();
+        server.printStats();
+    } catch (const std::exception& e) {
+        std::cerr << "Server error: " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
 void Menu::displayMainMenu() {
     std::cout << "Main Menu:\n";
     std::cout << "1. Binary Tree Menu\n";
@@ -32,6 +32,9 @@ public:
     // Constructor
     Menu();
     void mainMenu();
+    // Serves the tree and the list on a Unix domain socket until Ctrl+C (see Server.h).
+    // Returns false if the server could not start.
+    bool serve(const std::string& socket_path);
 };
 
 #endif
\ No newline at end of file